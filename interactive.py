@@ -7,10 +7,47 @@ GPS capture and validation
 Auto-calculation with verification
 """
 
-from main import BeamCalc, decode_plus_code, rolling_offset, calibrate
-import json
+from main import BeamCalc, JobJournal, JobWriter, decode_plus_code, job_summary, rolling_offset, calibrate
 from datetime import datetime
 from pathlib import Path
+import queue
+
+PAGE_SIZE = 20
+
+def open_journal():
+    """Job journal in $PTC_JOBS (default jobs/), taking over any old one-file-per-job saves once."""
+    journal = JobJournal()
+    if not len(journal):
+        legacy = sorted(str(p) for p in Path(journal.root).glob("job_*.json"))
+        if legacy:
+            print(f"Imported {journal.import_legacy(legacy)} saved job files into the journal.")
+    return journal
+
+_writer = None
+
+def job_writer():
+    """Saves go through one background writer so the prompt never waits on fsync."""
+    global _writer
+    if _writer is None:
+        _writer = JobWriter(open_journal())
+    return _writer
+
+_notices = queue.SimpleQueue()
+
+def report_save(future):
+    """Runs on the writer thread; the message waits for show_notices() on the main one."""
+    error = future.exception()
+    if error:
+        _notices.put(f"  ✗ Job NOT saved: {error}")
+    else:
+        _notices.put(f"  ✓ Saved as job {future.result()}.")
+
+def show_notices():
+    while True:
+        try:
+            print(_notices.get_nowait())
+        except queue.Empty:
+            return
 
 def get_float(prompt, default=None):
     while True:
@@ -37,12 +74,14 @@ def beam_wizard():
     
     # GPS/Location
     location = input("GPS or Plus Code (optional): ").strip()
+    area = None
     if location:
         try:
             area = decode_plus_code(location)
             print(f"  → Decoded: {area.lat:.6f}, {area.lon:.6f}")
-        except:
+        except Exception:
             print("  → Could not decode location")
+    crew = input("Crew (optional): ").strip()
     
     # Measurements
     circ = get_float("Beam circumference (inches)", 44)
@@ -57,12 +96,11 @@ def beam_wizard():
     # Save job
     save = input("Save this job? (y/n): ").strip().lower()
     if save == 'y':
-        jobs_dir = Path("jobs")
-        jobs_dir.mkdir(exist_ok=True)
-        
         job = {
             "timestamp": datetime.now().isoformat(),
             "location": location,
+            "lat": area.lat if area else None,
+            "lon": area.lon if area else None,
             "inputs": {
                 "circumference": circ,
                 "shoes": shoes,
@@ -74,18 +112,18 @@ def beam_wizard():
                 "band_qty": calc.band_qty,
                 "mesh_panels": calc.mesh_qty,
                 "total_mesh_sqft": calc.mesh_qty * calc.mesh_length * 40 / 144
-            }
+            },
+            "crew": crew or None  # last: extra keys trail the binary job record
         }
         
-        filename = jobs_dir / f"job_{datetime.now().strftime('%Y%m%d_%H%M%S')}.json"
-        with open(filename, 'w') as f:
-            json.dump(job, f, indent=2)
-        print(f"Saved: {filename}")
+        job_writer().submit(job).add_done_callback(report_save)
+        print("Saving...")
     
     return calc
 
 def main_menu():
     while True:
+        show_notices()
         print("\n" + "="*50)
         print("PIPE TRADES CLI - FIELD MODE")
         print("="*50)
@@ -124,21 +162,25 @@ def main_menu():
             print(f"\nDiff: {r['difference']:+.2f} ({r['pct_error']:+.2f}%)")
             print(status)
         elif choice == "5":
-            jobs_dir = Path("jobs")
-            if jobs_dir.exists():
-                for f in sorted(jobs_dir.glob("*.json")):
-                    print(f"  {f.name}")
-            else:
+            writer = job_writer()
+            writer.flush()
+            journal = writer.journal
+            stop = len(journal)
+            if not stop:
                 print("No saved jobs.")
+            while stop > 0:
+                start = max(stop - PAGE_SIZE, 0)
+                for job in reversed(journal.page(start, stop - start)):
+                    print(f"  {job_summary(job)}")
+                stop = start
+                if stop and input("Enter for older jobs, q to return: ").strip().lower() == "q":
+                    break
         elif choice == "0":
+            if _writer:
+                _writer.close()
+            show_notices()
             print("Exiting.")
             break
 
 if __name__ == "__main__":
     main_menu()
-
-git add interactive.py recon sandbox board_minutes.yaml
-git commit -m "feat: add interactive mode, recon config, sandbox scaffold"
-git push
-docker login
-docker push strategickhaos/pipe-trades-cli:latest
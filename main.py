@@ -9,16 +9,79 @@ Rolling offset calculations (mirrors Pipe Trades Pro 4095)
 
 Usage:
     python main.py decode "5MHH+P8G Lake Charles, Louisiana"
+    python main.py decode --batch survey.csv > survey.jsonl
+    python main.py encode --lat 30.179312 --lon -93.321687 --length 11 --near "Lake Charles"
+    python main.py encode --batch trace.csv > trace.jsonl
+    python main.py gazetteer build localities.csv -o gazetteer.bin
+    python main.py distance 30.2266,-93.2174 "5MHH+P8G Lake Charles" --unit mi --engine vincenty
+    python main.py distance structures.csv structures.csv --dtype f4 -o matrix.f4
+    python main.py distance 30.2266,-93.2174 30.2301,-93.2102 --engine local --origin "lake charles"
     python main.py beam --circ 44 --shoes 4 --boot 6 --rise 30
+    python main.py beam --batch rack.csv > takeoff.jsonl
+    python main.py beam sweep --circ 40:60:2 --shoes 0:8 --boot 0:12:0.5 --rise 0:60:5 --summary
+    python main.py optimize-cuts rack.csv --band-stock 1200 --mesh-stock 1800 --time-budget 5
     python main.py offset --angle 45 --offset 5
     python main.py calibrate --satellite 305 --field 305 --unit ft
+    python main.py calibrate --from 30.2266,-93.2174 --to 30.2270,-93.2174 --field 145.6 --engine vincenty
+    python main.py offset --angle 45 --offset 5 --format json
+    python main.py decode --batch survey.csv --format csv > decoded.csv
+    python main.py serve &                 # then ./ptc <command> forwards to it
+    python main.py jobs list --page 0 --per-page 20
+    python main.py jobs query "beam_length>60" --location sulphur --since 7d
+    python main.py jobs near "5MHH+P8G Lake Charles" --radius 300 --unit ft
+    python main.py jobs sync http://collector:8081   # collector: python main.py jobs collect --store central/
+    python main.py jobs reconcile /mnt/tablet2/jobs  # or a collector URL
+    python main.py export --columnar -o season.ptcc    # recon/data/ too: export recon/data/ --columnar
+    python main.py jobs totals --by crew --watch
+    python main.py http --port 8080        # POST /beam {"circ": 44, "shoes": 4}, GET /offset?angle=45&offset=5
+    printf 'offset --angle 45 --offset 5\nbeam --circ 44 --shoes 4\n' | python main.py --stdin
 """
 
 import argparse
+import atexit
+import bisect
+import collections
+import contextlib
+import csv
+import ctypes
+import glob
+import gzip
+import hashlib
+import io
+import itertools
+import json
 import math
+import mmap
+import multiprocessing
+import operator
+import os
+import queue
+import re
+import select
+import shlex
+import signal
+import socket
+import socketserver
+import struct
 import sys
+import threading
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+import zlib
+from array import array
+from concurrent.futures import Future
 from dataclasses import dataclass
-from typing import Tuple
+from datetime import datetime
+from functools import cache, cached_property, wraps
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from typing import Iterator, List, Sequence, Tuple
+
+try:
+    import fcntl
+except ImportError:  # Windows: single-writer journal
+    fcntl = None
 
 # ============================================================
 # CONSTANTS
@@ -29,6 +92,12 @@ CODE_ALPHABET = "23456789CFGHJMPQRVWX"
 SEPARATOR = "+"
 LATITUDE_MAX = 90
 LONGITUDE_MAX = 180
+PAIR_RESOLUTIONS = (20.0, 1.0, 0.05, 0.0025, 0.000125)
+PAIR_CODE_LENGTH = 10
+MAX_DIGIT_COUNT = 15
+GRID_ROWS, GRID_COLUMNS = 5, 4
+FINAL_LAT_PRECISION = 8000 * GRID_ROWS ** (MAX_DIGIT_COUNT - PAIR_CODE_LENGTH)
+FINAL_LON_PRECISION = 8000 * GRID_COLUMNS ** (MAX_DIGIT_COUNT - PAIR_CODE_LENGTH)
 
 REFERENCE_POINTS = {
     "lake charles": (30.2266, -93.2174),
@@ -36,11 +105,265 @@ REFERENCE_POINTS = {
     "louisiana": (30.9843, -91.9623),
 }
 
+GAZETTEER_MAGIC = b"PTCGAZ1\0"
+RESULT_CACHE_BYTES = int(os.environ.get("PTC_CACHE_BYTES", 4 << 20))  # per cached function
+
+# ============================================================
+# RESULT CACHE
+# ============================================================
+
+_MISS = object()
+
+
+def _approx_size(obj) -> int:
+    """Shallow size plus one level of contents; close enough to bound a cache."""
+    size = sys.getsizeof(obj)
+    if isinstance(obj, dict):
+        return size + sum(map(sys.getsizeof, obj.values()))
+    if isinstance(obj, tuple):
+        return size + sum(map(sys.getsizeof, obj))
+    if hasattr(obj, "__dict__"):
+        return size + _approx_size(obj.__dict__)
+    return size
+
+
+class ResultCache:
+    """Thread-safe LRU bounded by the approximate bytes of its keys and values.
+    
+    Values are shared between callers, so only immutable results (or copies)
+    should come out of it.
+    """
+    
+    ENTRY_OVERHEAD = 120  # OrderedDict node + (value, size) tuple
+    
+    def __init__(self, name: str, max_bytes: int = RESULT_CACHE_BYTES):
+        self.name, self.max_bytes = name, max_bytes
+        self._entries = collections.OrderedDict()
+        self._lock = threading.Lock()
+        self.bytes = self.hits = self.misses = self.evictions = 0
+    
+    def get(self, key, default=None):
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is None:
+                self.misses += 1
+                return default
+            self._entries.move_to_end(key)
+            self.hits += 1
+            return entry[0]
+    
+    def put(self, key, value):
+        size = _approx_size(key) + _approx_size(value) + self.ENTRY_OVERHEAD
+        with self._lock:
+            old = self._entries.pop(key, None)
+            if old is not None:
+                self.bytes -= old[1]
+            self._entries[key] = (value, size)
+            self.bytes += size
+            while self.bytes > self.max_bytes and len(self._entries) > 1:
+                _, (_, evicted) = self._entries.popitem(last=False)
+                self.bytes -= evicted
+                self.evictions += 1
+        return value
+    
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+            self.bytes = 0
+    
+    def stats(self) -> dict:
+        with self._lock:
+            lookups = self.hits + self.misses
+            return {"entries": len(self._entries), "bytes": self.bytes, "max_bytes": self.max_bytes,
+                    "hits": self.hits, "misses": self.misses, "evictions": self.evictions,
+                    "hit_rate": self.hits / lookups if lookups else 0.0}
+
+
+RESULT_CACHES = {}
+
+
+def result_cache(name: str, key, copy=None):
+    """Memoize a function on key(*args); copy() hands out mutable results safely."""
+    cache = RESULT_CACHES[name] = ResultCache(name)
+    
+    def wrap(fn):
+        @wraps(fn)
+        def cached(*args):
+            k = key(*args)
+            value = cache.get(k, _MISS)
+            if value is _MISS:
+                value = cache.put(k, fn(*args))
+            return copy(value) if copy else value
+        cached.cache = cache
+        return cached
+    return wrap
+
+
+def cache_stats() -> dict:
+    return {name: cache.stats() for name, cache in RESULT_CACHES.items()}
+
+# ============================================================
+# LOCALITY GAZETTEER
+# ============================================================
+
+_GAZ_HEADER = struct.Struct("<8sIIII")
+_BYTES = tuple(bytes([b]) for b in range(256))
+
+
+def _align8(n: int) -> int:
+    return (n + 7) & ~7
+
+
+class Gazetteer:
+    """Locality table with an Aho-Corasick matcher over lower-cased names.
+
+    Stored as flat native arrays (CSR edges, fail links, per-node output) so a
+    built file is memory-mapped and used without parsing. Matching is
+    O(len(text)) whatever the table size. Like the REFERENCE_POINTS scan it
+    replaces, the earliest row among all names found in the text wins, so list
+    plant units and gates before the towns and states around them.
+
+    `source` identifies the table for result-cache keys: (path, mtime, size)
+    for a loaded file, a digest of the bytes for one built in memory.
+    """
+    
+    def __init__(self, buf, source=None):
+        magic, n_nodes, n_edges, n_entries, names_len = _GAZ_HEADER.unpack_from(buf, 0)
+        if magic != GAZETTEER_MAGIC or sys.byteorder != "little":
+            raise ValueError("not a gazetteer file for this platform")
+        view, off = memoryview(buf), _GAZ_HEADER.size
+        
+        def take(fmt: str, count: int, size: int):
+            nonlocal off
+            start, off = off, _align8(off + count * size)
+            return view[start:start + count * size].cast(fmt)
+        
+        self._buf = buf
+        self.source = source or hashlib.blake2b(buf, digest_size=16).hexdigest()
+        self._coords = take("d", 2 * n_entries, 8)
+        self._edge_start = take("I", n_nodes + 1, 4)
+        self._edge_target = take("I", n_edges, 4)
+        self._fail = take("I", n_nodes, 4)
+        self._out = take("i", n_nodes, 4)
+        self._name_off = take("I", n_entries + 1, 4)
+        self._edge_base = off
+        self._names = view[_align8(off + n_edges):_align8(off + n_edges) + names_len]
+        self._prefixes = {}
+    
+    @staticmethod
+    def build(entries) -> bytes:
+        """Serialize (name, lat, lon) rows; duplicate names keep the first row."""
+        trie, term, names, coords = [{}], [-1], [], []
+        for name, lat, lon in entries:
+            key = name.strip().lower().encode("utf-8")
+            node = 0
+            for b in key:
+                if b not in trie[node]:
+                    trie[node][b] = len(trie)
+                    trie.append({})
+                    term.append(-1)
+                node = trie[node][b]
+            if key and term[node] < 0:
+                term[node] = len(names)
+                names.append(name.strip().encode("utf-8"))
+                coords += (float(lat), float(lon))
+        
+        fail, out, queue = [0] * len(trie), term[:], [0]
+        for node in queue:
+            for b, child in trie[node].items():
+                f = fail[node]
+                while node and f and b not in trie[f]:
+                    f = fail[f]
+                fail[child] = trie[f].get(b, 0) if node else 0
+                inherited = out[fail[child]]
+                if inherited >= 0 and (out[child] < 0 or inherited < out[child]):
+                    out[child] = inherited
+                queue.append(child)
+        
+        edge_start, edge_bytes, edge_target = [0], bytearray(), []
+        for edges in trie:
+            for b in sorted(edges):
+                edge_bytes.append(b)
+                edge_target.append(edges[b])
+            edge_start.append(len(edge_target))
+        name_off = list(itertools.accumulate(map(len, names), initial=0))
+        blob = b"".join(names)
+        
+        parts = [
+            _GAZ_HEADER.pack(GAZETTEER_MAGIC, len(trie), len(edge_target), len(names), len(blob)),
+            array("d", coords).tobytes(), array("I", edge_start).tobytes(),
+            array("I", edge_target).tobytes(), array("I", fail).tobytes(),
+            array("i", out).tobytes(), array("I", name_off).tobytes(),
+            bytes(edge_bytes), blob,
+        ]
+        return b"".join(p + b"\0" * (_align8(len(p)) - len(p)) for p in parts)
+    
+    @classmethod
+    def from_points(cls, points: dict) -> "Gazetteer":
+        return cls(cls.build((name, lat, lon) for name, (lat, lon) in points.items()))
+    
+    @classmethod
+    def load(cls, path: str) -> "Gazetteer":
+        with open(path, "rb") as f:
+            st = os.fstat(f.fileno())
+            return cls(mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ),
+                       (os.path.abspath(path), st.st_mtime_ns, st.st_size))
+    
+    def __len__(self) -> int:
+        return len(self._name_off) - 1
+    
+    def name(self, i: int) -> str:
+        return bytes(self._names[self._name_off[i]:self._name_off[i + 1]]).decode("utf-8")
+    
+    def coords(self, i: int) -> Tuple[float, float]:
+        return self._coords[2 * i], self._coords[2 * i + 1]
+    
+    def prefix(self, i: int) -> str:
+        """Leading 4 digits recovered for locality `i`, memoized per gazetteer."""
+        p = self._prefixes.get(i)
+        if p is None:
+            p = self._prefixes[i] = locality_prefix(*self.coords(i))
+        return p
+    
+    def match(self, text: str) -> int:
+        find, base = self._buf.find, self._edge_base
+        starts, targets, fail, out = self._edge_start, self._edge_target, self._fail, self._out
+        node, best = 0, len(self)
+        for b in text.lower().encode("utf-8"):
+            while True:
+                i = find(_BYTES[b], base + starts[node], base + starts[node + 1])
+                if i >= 0:
+                    node = targets[i - base]
+                    break
+                if not node:
+                    break
+                node = fail[node]
+            if 0 <= out[node] < best:
+                best = out[node]
+        return best if best < len(self) else -1
+
+
+_gazetteer = None
+
+
+def gazetteer() -> Gazetteer:
+    global _gazetteer
+    if _gazetteer is None:
+        path = os.environ.get("PTC_GAZETTEER")
+        _gazetteer = Gazetteer.load(path) if path else Gazetteer.from_points(REFERENCE_POINTS)
+    return _gazetteer
+
+
+def use_gazetteer(path: str):
+    global _gazetteer
+    _gazetteer = Gazetteer.load(path)
+
+
 # ============================================================
 # GPS / PLUS CODE
 # ============================================================
 
-@dataclass
+@dataclass(frozen=True)
 class CodeArea:
     south: float
     west: float
@@ -54,62 +377,554 @@ class CodeArea:
     @property
     def lon(self) -> float:
         return (self.west + self.east) / 2
+    
+    def as_dict(self) -> dict:
+        return {
+            "south": self.south, "west": self.west,
+            "north": self.north, "east": self.east,
+            "lat": self.lat, "lon": self.lon,
+        }
 
 
-def decode_plus_code(code: str) -> CodeArea:
+def locality_prefix(ref_lat: float, ref_lon: float) -> str:
+    lat_val = ref_lat + LATITUDE_MAX
+    lon_val = ref_lon + LONGITUDE_MAX
+    c1 = CODE_ALPHABET[int(lat_val / 20)]
+    c2 = CODE_ALPHABET[int(lon_val / 20)]
+    c3 = CODE_ALPHABET[int((lat_val % 20) / 1)]
+    c4 = CODE_ALPHABET[int((lon_val % 20) / 1)]
+    return f"{c1}{c2}{c3}{c4}"
+
+
+def find_locality(text: str):
+    g = gazetteer()
+    i = g.match(text)
+    return None if i < 0 else (g.name(i), g.coords(i))
+
+
+def full_code(code: str) -> str:
+    """Upper-cased first token of `code`, short codes recovered from a locality."""
     original = code.strip()
-    ref_lat, ref_lon = None, None
-    
-    for loc_key, coords in REFERENCE_POINTS.items():
-        if loc_key in original.lower():
-            ref_lat, ref_lon = coords
-            break
-    
     code_part = original.upper().split()[0]
     
     if SEPARATOR in code_part:
         prefix, suffix = code_part.split(SEPARATOR)
-        if len(prefix) < 8 and ref_lat is not None:
-            lat_val = ref_lat + LATITUDE_MAX
-            lon_val = ref_lon + LONGITUDE_MAX
-            c1 = CODE_ALPHABET[int(lat_val / 20)]
-            c2 = CODE_ALPHABET[int(lon_val / 20)]
-            c3 = CODE_ALPHABET[int((lat_val % 20) / 1)]
-            c4 = CODE_ALPHABET[int((lon_val % 20) / 1)]
-            code_part = f"{c1}{c2}{c3}{c4}{code_part}"
-    
-    code = code_part.replace(SEPARATOR, "")
-    
-    PAIR_RESOLUTIONS = [20.0, 1.0, 0.05, 0.0025, 0.000125]
+        if len(prefix) < 8:
+            g = gazetteer()
+            i = g.match(original)
+            if i >= 0:
+                code_part = g.prefix(i) + code_part
+    
+    return code_part
+
+
+def _decode_key(code: str):
+    """Full codes key on the code alone; short codes also on locality text and gazetteer source."""
+    token, *rest = code.split(None, 1)
+    token = token.upper()
+    if token.find(SEPARATOR) >= 8:
+        return token
+    return token, rest[0].lower() if rest else "", gazetteer().source
+
+
+@result_cache("decode", _decode_key)
+def decode_plus_code(code: str) -> CodeArea:
+    code = full_code(code).replace(SEPARATOR, "").rstrip("0")
+    
     south, west = 0.0, 0.0
     lat_res, lon_res = PAIR_RESOLUTIONS[0], PAIR_RESOLUTIONS[0]
     
-    for i in range(0, min(len(code), 10), 2):
+    for i in range(0, min(len(code), PAIR_CODE_LENGTH), 2):
         lat_res = PAIR_RESOLUTIONS[i // 2]
         lon_res = PAIR_RESOLUTIONS[i // 2]
         south += CODE_ALPHABET.index(code[i]) * lat_res
         west += CODE_ALPHABET.index(code[i + 1]) * lon_res
     
+    # grid refinement: each digit past 10 splits the cell into 5 rows x 4 columns
+    for ch in code[PAIR_CODE_LENGTH:MAX_DIGIT_COUNT]:
+        row, col = divmod(CODE_ALPHABET.index(ch), GRID_COLUMNS)
+        lat_res /= GRID_ROWS
+        lon_res /= GRID_COLUMNS
+        south += row * lat_res
+        west += col * lon_res
+    
     south -= LATITUDE_MAX
     west -= LONGITUDE_MAX
     
     return CodeArea(south=south, west=west, north=south + lat_res, east=west + lon_res)
 
 
+# Column decoder. Codes are grouped by length and joined into one byte blob so
+# each digit position is a strided slice; characters map straight to degree
+# terms through 256-entry tables (NaN for anything outside the alphabet), and
+# the columns are summed in the same order as decode_plus_code so both paths
+# agree bit for bit.
+
+def _term_table(res: float) -> Tuple[float, ...]:
+    table = [math.nan] * 256
+    for digit, ch in enumerate(CODE_ALPHABET):
+        table[ord(ch)] = table[ord(ch.lower())] = digit * res
+    return tuple(table)
+
+
+def _grid_tables(lat_res: float, lon_res: float):
+    for _ in range(MAX_DIGIT_COUNT - PAIR_CODE_LENGTH):
+        lat_res /= GRID_ROWS
+        lon_res /= GRID_COLUMNS
+        lat_t, lon_t = [math.nan] * 256, [math.nan] * 256
+        for digit, ch in enumerate(CODE_ALPHABET):
+            row, col = divmod(digit, GRID_COLUMNS)
+            lat_t[ord(ch)] = lat_t[ord(ch.lower())] = row * lat_res
+            lon_t[ord(ch)] = lon_t[ord(ch.lower())] = col * lon_res
+        yield tuple(lat_t), tuple(lon_t), lat_res, lon_res
+
+
+_PAIR_TERMS = tuple(_term_table(res) for res in PAIR_RESOLUTIONS)
+_GRID_TERMS = tuple(_grid_tables(PAIR_RESOLUTIONS[-1], PAIR_RESOLUTIONS[-1]))
+
+
+@dataclass
+class CodeAreaBatch:
+    """Struct-of-arrays CodeArea; rows that failed to decode hold NaN."""
+    south: array
+    west: array
+    north: array
+    east: array
+    
+    def __len__(self) -> int:
+        return len(self.south)
+    
+    def __getitem__(self, i: int) -> CodeArea:
+        return CodeArea(self.south[i], self.west[i], self.north[i], self.east[i])
+    
+    @property
+    def lat(self) -> array:
+        return array("d", map(lambda s, n: (s + n) / 2, self.south, self.north))
+    
+    @property
+    def lon(self) -> array:
+        return array("d", map(lambda w, e: (w + e) / 2, self.west, self.east))
+    
+    def valid(self, i: int) -> bool:
+        return not math.isnan(self.south[i])
+
+
+def decode_plus_codes(codes) -> CodeAreaBatch:
+    n = len(codes)
+    south, west = array("d", [math.nan]) * n, array("d", [math.nan]) * n
+    north, east = array("d", [math.nan]) * n, array("d", [math.nan]) * n
+    
+    tokens = [c.split(None, 1)[0].upper() if c and not c.isspace() else "" for c in codes]
+    for i, token in enumerate(tokens):
+        if token and token.find(SEPARATOR) < 8:
+            try:
+                tokens[i] = full_code(codes[i])
+            except (IndexError, ValueError):
+                tokens[i] = ""
+    blob = "\n".join(tokens).encode("ascii", "replace").translate(None, b"+")
+    lines = blob.split(b"\n")
+    if b"0" in blob:  # only trailing padding goes; a '0' anywhere else hits NaN in the tables
+        lines = [line.rstrip(b"0") for line in lines]
+    
+    lengths = set(map(len, lines))
+    if len(lengths) == 1:
+        groups = {lengths.pop(): (range(n), lines)}
+    else:
+        groups = {}
+        for i, raw in enumerate(lines):
+            rows, raws = groups.setdefault(len(raw), ([], []))
+            rows.append(i)
+            raws.append(raw)
+    
+    for stride, (rows, raws) in groups.items():
+        pairs = min(stride, PAIR_CODE_LENGTH) // 2
+        if not pairs or stride % 2 and stride < PAIR_CODE_LENGTH:
+            continue
+        blob = b"".join(raws)
+        s_col = w_col = None
+        for k in range(pairs):
+            terms = _PAIR_TERMS[k].__getitem__
+            s_terms = map(terms, blob[2 * k::stride])
+            w_terms = map(terms, blob[2 * k + 1::stride])
+            s_col = list(s_terms) if s_col is None else list(map(operator.add, s_col, s_terms))
+            w_col = list(w_terms) if w_col is None else list(map(operator.add, w_col, w_terms))
+        lat_res = lon_res = PAIR_RESOLUTIONS[pairs - 1]
+        for k in range(max(min(stride, MAX_DIGIT_COUNT) - PAIR_CODE_LENGTH, 0)):
+            lat_t, lon_t, lat_res, lon_res = _GRID_TERMS[k]
+            col = blob[PAIR_CODE_LENGTH + k::stride]
+            s_col = list(map(operator.add, s_col, map(lat_t.__getitem__, col)))
+            w_col = list(map(operator.add, w_col, map(lon_t.__getitem__, col)))
+        for i, s, w in zip(rows, s_col, w_col):
+            if s != s or w != w:  # a character outside the alphabet; the row stays NaN
+                continue
+            s -= LATITUDE_MAX
+            w -= LONGITUDE_MAX
+            south[i], west[i], north[i], east[i] = s, w, s + lat_res, w + lon_res
+    
+    return CodeAreaBatch(south, west, north, east)
+
+
+def _lat_precision(length: int) -> float:
+    if length <= PAIR_CODE_LENGTH:
+        return 20.0 ** (length // -2 + 2)
+    return 20.0 ** -3 / GRID_ROWS ** (length - PAIR_CODE_LENGTH)
+
+
+def _check_length(length: int):
+    if length < 2 or length > MAX_DIGIT_COUNT or (length < PAIR_CODE_LENGTH and length % 2):
+        raise ValueError(f"invalid code length {length}")
+
+
+def _encode_ints(lat: float, lon: float, length: int) -> Tuple[int, int]:
+    # latitude 90 belongs to the top cell at this length, not past it
+    lat = min(max(lat, -LATITUDE_MAX), LATITUDE_MAX - _lat_precision(length))
+    return (int(round((lat + LATITUDE_MAX) * FINAL_LAT_PRECISION, 6)),
+            int(round(((lon + LONGITUDE_MAX) % 360) * FINAL_LON_PRECISION, 6)))
+
+
+def _format_code(digits: str, length: int) -> str:
+    if length >= 8:
+        return f"{digits[:8]}{SEPARATOR}{digits[8:length]}"
+    return f"{digits[:length]:0<8}{SEPARATOR}"
+
+
+def encode_plus_code(lat: float, lon: float, length: int = PAIR_CODE_LENGTH) -> str:
+    _check_length(length)
+    lat_val, lon_val = _encode_ints(lat, lon, length)
+    
+    code = ""
+    for _ in range(MAX_DIGIT_COUNT - PAIR_CODE_LENGTH):
+        lat_val, row = divmod(lat_val, GRID_ROWS)
+        lon_val, col = divmod(lon_val, GRID_COLUMNS)
+        code = CODE_ALPHABET[row * GRID_COLUMNS + col] + code
+    for _ in range(PAIR_CODE_LENGTH // 2):
+        lat_val, lat_d = divmod(lat_val, 20)
+        lon_val, lon_d = divmod(lon_val, 20)
+        code = CODE_ALPHABET[lat_d] + CODE_ALPHABET[lon_d] + code
+    
+    return _format_code(code, length)
+
+
+_PAIR_CHARS = tuple(a + b for a in CODE_ALPHABET for b in CODE_ALPHABET)
+
+
+def encode_plus_codes(lats: Sequence[float], lons: Sequence[float],
+                      length: int = PAIR_CODE_LENGTH) -> List[str]:
+    """Batch encode_plus_code.
+
+    Lat/lon digit pairs index a 400-entry table of two-character strings, so
+    the five pairs cost five lookups instead of ten divmods and concatenations.
+    """
+    _check_length(length)
+    top = LATITUDE_MAX - _lat_precision(length)
+    grid = MAX_DIGIT_COUNT - PAIR_CODE_LENGTH
+    lat_div, lon_div = GRID_ROWS ** grid, GRID_COLUMNS ** grid
+    steps = [(GRID_ROWS ** (grid - 1 - g), GRID_COLUMNS ** (grid - 1 - g)) for g in range(length - PAIR_CODE_LENGTH)]
+    pairs, alphabet = _PAIR_CHARS, CODE_ALPHABET
+    
+    codes = []
+    for lat, lon in zip(lats, lons):
+        lat_val = int(round((min(max(lat, -LATITUDE_MAX), top) + LATITUDE_MAX) * FINAL_LAT_PRECISION, 6))
+        lon_val = int(round(((lon + LONGITUDE_MAX) % 360) * FINAL_LON_PRECISION, 6))
+        a, b = divmod(lat_val // lat_div, 400)
+        c, d = divmod(lon_val // lon_div, 400)
+        code = (pairs[a // 400 * 20 + c // 400] + pairs[a // 20 % 20 * 20 + c // 20 % 20]
+                + pairs[a % 20 * 20 + c % 20] + pairs[b // 20 * 20 + d // 20]
+                + SEPARATOR + pairs[b % 20 * 20 + d % 20])
+        for row_div, col_div in steps:
+            code += alphabet[lat_val // row_div % GRID_ROWS * GRID_COLUMNS + lon_val // col_div % GRID_COLUMNS]
+        codes.append(code)
+    
+    if length < PAIR_CODE_LENGTH:
+        codes = [_format_code(c.replace(SEPARATOR, ""), length) for c in codes]
+    return codes
+
+
+def shorten_plus_code(code: str, locality: str) -> str:
+    """Drop the 4 leading digits the decoder recovers from `locality`.
+
+    Returns `code` unchanged when the locality is unknown or the code lies
+    outside the locality's 1-degree cell, so the result always decodes back.
+    """
+    g = gazetteer()
+    i = g.match(locality)
+    if i < 0 or len(code) < 9 or not code.startswith(g.prefix(i)):
+        return code
+    return f"{code[4:]} {locality.strip()}"
+
+
 # ============================================================
 # DISTANCE CALCULATIONS
 # ============================================================
 
+R_FT = 20902231
+UNIT_CONV = {"ft": 1, "in": 12, "m": 0.3048, "mi": 1/5280}
+
+
 def haversine(lat1: float, lon1: float, lat2: float, lon2: float, unit: str = "ft") -> float:
-    R_FT = 20902231
     lat1_r, lat2_r = math.radians(lat1), math.radians(lat2)
     dlat, dlon = math.radians(lat2 - lat1), math.radians(lon2 - lon1)
     
     a = math.sin(dlat/2)**2 + math.cos(lat1_r) * math.cos(lat2_r) * math.sin(dlon/2)**2
     dist_ft = R_FT * 2 * math.atan2(math.sqrt(a), math.sqrt(1-a))
     
-    conv = {"ft": 1, "in": 12, "m": 0.3048, "mi": 1/5280}
-    return dist_ft * conv.get(unit, 1)
+    return dist_ft * UNIT_CONV.get(unit, 1)
+
+
+WGS84_A = 6378137.0
+WGS84_F = 1 / 298.257223563
+WGS84_B = WGS84_A * (1 - WGS84_F)
+_WGS84_EP2 = (WGS84_A ** 2 - WGS84_B ** 2) / WGS84_B ** 2
+
+
+@dataclass
+class PointSet:
+    """Column store of points with each engine's per-point trig cached.
+
+    Haversine: sin(dlat/2) and sin(dlon/2) expand into products of half-angle
+    sines and cosines, so a pair costs multiplies plus one sqrt/asin.
+    Vincenty: the reduced latitude's sin/cos is computed once per point.
+    """
+    lat: array
+    lon: array
+    
+    def __len__(self) -> int:
+        return len(self.lat)
+    
+    @cached_property
+    def _half(self) -> Tuple[array, array, array, array]:
+        half_lat = [math.radians(x) / 2 for x in self.lat]
+        half_lon = [math.radians(x) / 2 for x in self.lon]
+        return (array("d", map(math.sin, half_lat)), array("d", map(math.cos, half_lat)),
+                array("d", map(math.sin, half_lon)), array("d", map(math.cos, half_lon)))
+    
+    @cached_property
+    def cos_lat(self) -> array:
+        return array("d", map(math.cos, map(math.radians, self.lat)))
+    
+    @cached_property
+    def lon_r(self) -> array:
+        return array("d", map(math.radians, self.lon))
+    
+    @cached_property
+    def reduced(self) -> Tuple[array, array]:
+        u = [math.atan((1 - WGS84_F) * math.tan(math.radians(x))) for x in self.lat]
+        return array("d", map(math.sin, u)), array("d", map(math.cos, u))
+    
+    def projected(self, grid: "LocalGrid") -> Tuple[array, array, List[bool]]:
+        """Plant-grid x/y (feet) and in-bounds flags, projected once per grid."""
+        cached = self.__dict__.setdefault("_projections", {}).get(grid)
+        if cached is None:
+            kx, ky = grid.scale
+            cached = self._projections[grid] = (
+                array("d", ((x - grid.lon0) * kx for x in self.lon)),
+                array("d", ((y - grid.lat0) * ky for y in self.lat)),
+                list(map(grid.contains, self.lat, self.lon)),
+            )
+        return cached
+
+
+def haversine_many(lat: float, lon: float, points: PointSet, unit: str = "ft") -> array:
+    """Distances from one origin to every point, as haversine() computes them."""
+    h_lat, h_lon = math.radians(lat) / 2, math.radians(lon) / 2
+    s_lat, c_lat, s_lon, c_lon = math.sin(h_lat), math.cos(h_lat), math.sin(h_lon), math.cos(h_lon)
+    cos_o = math.cos(2 * h_lat)
+    k = R_FT * 2 * UNIT_CONV.get(unit, 1)
+    asin, sqrt = math.asin, math.sqrt
+    
+    out = array("d")
+    append = out.append
+    for sb, cb, sl, cl, cos_p in zip(*points._half[:2], *points._half[2:], points.cos_lat):
+        dy = sb * c_lat - cb * s_lat
+        dx = sl * c_lon - cl * s_lon
+        a = dy * dy + cos_o * cos_p * dx * dx
+        append(k * asin(sqrt(a if a < 1.0 else 1.0)))
+    return out
+
+
+def _reduced(lat: float) -> Tuple[float, float]:
+    u = math.atan((1 - WGS84_F) * math.tan(math.radians(lat)))
+    return math.sin(u), math.cos(u)
+
+
+def _vincenty_m(sin_u1: float, cos_u1: float, sin_u2: float, cos_u2: float, dlon: float) -> float:
+    """Vincenty inverse on WGS84 in metres; NaN if it fails to converge (near-antipodal)."""
+    f, sin, cos = WGS84_F, math.sin, math.cos
+    ss, cc = sin_u1 * sin_u2, cos_u1 * cos_u2
+    cs, sc = cos_u1 * sin_u2, sin_u1 * cos_u2
+    lam = dlon
+    for _ in range(200):
+        sin_lam, cos_lam = sin(lam), cos(lam)
+        t = cs - sc * cos_lam
+        sin_sigma = math.sqrt(cos_u2 * sin_lam * cos_u2 * sin_lam + t * t)
+        if sin_sigma == 0:
+            return 0.0
+        cos_sigma = ss + cc * cos_lam
+        sigma = math.atan2(sin_sigma, cos_sigma)
+        sin_alpha = cc * sin_lam / sin_sigma
+        cos2_alpha = 1 - sin_alpha * sin_alpha
+        cos_2sm = cos_sigma - 2 * ss / cos2_alpha if cos2_alpha else 0.0
+        c = f / 16 * cos2_alpha * (4 + f * (4 - 3 * cos2_alpha))
+        prev = lam
+        lam = dlon + (1 - c) * f * sin_alpha * (
+            sigma + c * sin_sigma * (cos_2sm + c * cos_sigma * (-1 + 2 * cos_2sm * cos_2sm)))
+        if -1e-12 < lam - prev < 1e-12:
+            break
+    else:
+        return math.nan
+    
+    u2 = cos2_alpha * _WGS84_EP2
+    a = 1 + u2 / 16384 * (4096 + u2 * (-768 + u2 * (320 - 175 * u2)))
+    b = u2 / 1024 * (256 + u2 * (-128 + u2 * (74 - 47 * u2)))
+    d_sigma = b * sin_sigma * (cos_2sm + b / 4 * (
+        cos_sigma * (-1 + 2 * cos_2sm * cos_2sm)
+        - b / 6 * cos_2sm * (-3 + 4 * sin_sigma * sin_sigma) * (-3 + 4 * cos_2sm * cos_2sm)))
+    return WGS84_B * a * (sigma - d_sigma)
+
+
+def vincenty(lat1: float, lon1: float, lat2: float, lon2: float, unit: str = "ft") -> float:
+    m = _vincenty_m(*_reduced(lat1), *_reduced(lat2), math.radians(lon2 - lon1))
+    if math.isnan(m):
+        return haversine(lat1, lon1, lat2, lon2, unit)
+    return m / 0.3048 * UNIT_CONV.get(unit, 1)
+
+
+def vincenty_many(lat: float, lon: float, points: PointSet, unit: str = "ft") -> array:
+    """vincenty() from one origin; per-point reduced latitudes come from the PointSet cache."""
+    sin_u1, cos_u1 = _reduced(lat)
+    lon_r, k = math.radians(lon), UNIT_CONV.get(unit, 1) / 0.3048
+    sin_u, cos_u = points.reduced
+    out = array("d", [
+        _vincenty_m(sin_u1, cos_u1, s, c, l - lon_r) * k
+        for s, c, l in zip(sin_u, cos_u, points.lon_r)
+    ])
+    for i in (i for i, d in enumerate(out) if math.isnan(d)):
+        out[i] = haversine(lat, lon, points.lat[i], points.lon[i], unit)
+    return out
+
+
+RECON_CONFIG = os.path.join(os.path.dirname(os.path.abspath(__file__)), "recon", "grok_config.yaml")
+
+
+def read_gps_bounds(path: str) -> Tuple[float, float, float, float]:
+    """(south, west, north, east) from the `gps_bounds:` block of a recon config."""
+    bounds, indent = {}, None
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            stripped = line.split("#", 1)[0].rstrip()
+            depth = len(stripped) - len(stripped.lstrip())
+            if indent is None:
+                if stripped.strip() == "gps_bounds:":
+                    indent = depth
+            elif stripped and depth <= indent:
+                break
+            elif ":" in stripped:
+                key, value = stripped.split(":", 1)
+                bounds[key.strip()] = float(value)
+    try:
+        return bounds["south"], bounds["west"], bounds["north"], bounds["east"]
+    except KeyError:
+        raise ValueError(f"{path}: no complete gps_bounds block") from None
+
+
+@dataclass(frozen=True)
+class LocalGrid:
+    """Plant grid: a tangent plane at an origin, in feet east/north.
+    
+    Degrees scale by the WGS84 meridional and prime-vertical radii at the
+    origin, then distances are plain pythagorean(). The east-west scale drifts
+    with latitude, so the relative error against the ellipsoid is bounded by
+    tan(lat0) * dlat + dlat**2 (dlat = furthest bound from the origin, in
+    radians): about 0.05% for the Lake Charles corridor, against ~0.3% for
+    haversine. Pairs with a point outside the bounds fall back to haversine.
+    """
+    lat0: float
+    lon0: float
+    south: float
+    west: float
+    north: float
+    east: float
+    
+    @classmethod
+    def from_bounds(cls, south: float, west: float, north: float, east: float) -> "LocalGrid":
+        return cls((south + north) / 2, (west + east) / 2, south, west, north, east)
+    
+    @classmethod
+    def around(cls, lat: float, lon: float, radius_deg: float = 0.05) -> "LocalGrid":
+        return cls(lat, lon, lat - radius_deg, lon - radius_deg, lat + radius_deg, lon + radius_deg)
+    
+    @cached_property
+    def scale(self) -> Tuple[float, float]:
+        """Feet per degree of longitude and of latitude at the origin."""
+        phi = math.radians(self.lat0)
+        e2 = WGS84_F * (2 - WGS84_F)
+        w = 1 - e2 * math.sin(phi) ** 2
+        per_rad = math.pi / 180 / 0.3048
+        return (WGS84_A / math.sqrt(w) * math.cos(phi) * per_rad,
+                WGS84_A * (1 - e2) / w ** 1.5 * per_rad)
+    
+    @property
+    def error_bound(self) -> float:
+        dlat = math.radians(max(self.north - self.lat0, self.lat0 - self.south))
+        return abs(math.tan(math.radians(self.lat0))) * dlat + dlat * dlat
+    
+    def contains(self, lat: float, lon: float) -> bool:
+        return self.south <= lat <= self.north and self.west <= lon <= self.east
+    
+    def project(self, lat: float, lon: float) -> Tuple[float, float]:
+        kx, ky = self.scale
+        return (lon - self.lon0) * kx, (lat - self.lat0) * ky
+    
+    def distance(self, lat1: float, lon1: float, lat2: float, lon2: float, unit: str = "ft") -> float:
+        if not (self.contains(lat1, lon1) and self.contains(lat2, lon2)):
+            return haversine(lat1, lon1, lat2, lon2, unit)
+        x1, y1 = self.project(lat1, lon1)
+        x2, y2 = self.project(lat2, lon2)
+        return pythagorean(x2 - x1, y2 - y1) * UNIT_CONV.get(unit, 1)
+    
+    def distance_many(self, lat: float, lon: float, points: PointSet, unit: str = "ft") -> array:
+        if not self.contains(lat, lon):
+            return haversine_many(lat, lon, points, unit)
+        xs, ys, inside = points.projected(self)
+        x0, y0 = self.project(lat, lon)
+        k, sqrt = UNIT_CONV.get(unit, 1), math.sqrt
+        out = array("d", [sqrt((x - x0) * (x - x0) + (y - y0) * (y - y0)) * k for x, y in zip(xs, ys)])
+        if not all(inside):
+            for i in (i for i, ok in enumerate(inside) if not ok):
+                out[i] = haversine(lat, lon, points.lat[i], points.lon[i], unit)
+        return out
+
+
+_local_grid = None
+
+
+def local_grid() -> LocalGrid:
+    global _local_grid
+    if _local_grid is None:
+        _local_grid = LocalGrid.from_bounds(*read_gps_bounds(os.environ.get("PTC_GRID", RECON_CONFIG)))
+    return _local_grid
+
+
+def use_local_grid(grid: LocalGrid):
+    global _local_grid
+    _local_grid = grid
+
+
+GEODESIC_ENGINES = {
+    "haversine": (haversine, haversine_many),
+    "vincenty": (vincenty, vincenty_many),
+    "local": (lambda *a: local_grid().distance(*a), lambda *a: local_grid().distance_many(*a)),
+}
+
+
+def geodesic(lat1: float, lon1: float, lat2: float, lon2: float, unit: str = "ft",
+             engine: str = "haversine") -> float:
+    return GEODESIC_ENGINES[engine][0](lat1, lon1, lat2, lon2, unit)
+
+
+def geodesic_many(lat: float, lon: float, points: PointSet, unit: str = "ft",
+                  engine: str = "haversine") -> array:
+    return GEODESIC_ENGINES[engine][1](lat, lon, points, unit)
 
 
 def pythagorean(run: float, rise: float) -> float:
@@ -120,37 +935,112 @@ def pythagorean(run: float, rise: float) -> float:
 # BEAM WRAP CALCULATIONS
 # ============================================================
 
-@dataclass
+BEAM_COLUMNS = ("circumference", "shoe_count", "boot_final", "rise", "run", "beam_length",
+                "band_length", "band_qty", "total_band_in", "mesh_length", "mesh_qty", "total_mesh_sqft")
+BAND_ALLOWANCE = 8  # inches past the circumference: +7" bander grab +1" clip
+
+
+class BeamBatch:
+    """Struct-of-arrays beam takeoff.
+    
+    Inputs are contiguous columns; every derived column is a cached_property
+    built from the columns it depends on, so each is computed exactly once
+    per batch however many consumers read it.
+    """
+    
+    def __init__(self, circumference, shoe_count, boot_final, rise, shoe_size=None):
+        self.circumference = array("d", circumference)
+        self.shoe_count = array("q", map(int, shoe_count))
+        self.boot_final = array("d", boot_final)
+        self.rise = array("d", rise)
+        if shoe_size is None:
+            self.shoe_size = array("d", [SHOE_SIZE]) * len(self.circumference)
+        else:
+            self.shoe_size = array("d", shoe_size)
+    
+    def __len__(self) -> int:
+        return len(self.circumference)
+    
+    @cached_property
+    def run(self) -> array:
+        return array("d", map(lambda n, size, boot: (n * size) + boot,
+                              self.shoe_count, self.shoe_size, self.boot_final))
+    
+    @cached_property
+    def beam_length(self) -> array:
+        return array("d", map(lambda run, rise: pythagorean(run, rise) if rise else run,
+                              self.run, self.rise))
+    
+    @cached_property
+    def band_length(self) -> array:
+        return array("d", (c + BAND_ALLOWANCE for c in self.circumference))
+    
+    @cached_property
+    def band_qty(self) -> array:
+        return array("q", (math.ceil(length / 40) + 1 for length in self.beam_length))
+    
+    @cached_property
+    def mesh_length(self) -> array:
+        return array("d", (c + 19 for c in self.circumference))  # +12" corners +3" overlap +4" edge
+    
+    @cached_property
+    def mesh_qty(self) -> array:
+        return array("q", (max(qty - 1, 1) for qty in self.band_qty))
+    
+    @cached_property
+    def total_band_in(self) -> array:
+        return array("d", map(operator.mul, self.band_qty, self.band_length))
+    
+    @cached_property
+    def total_mesh_sqft(self) -> array:
+        return array("d", map(lambda qty, length: qty * length * 40 / 144, self.mesh_qty, self.mesh_length))
+    
+    def rows(self) -> List[dict]:
+        return [dict(zip(BEAM_COLUMNS, values))
+                for values in zip(*(getattr(self, name) for name in BEAM_COLUMNS))]
+
+
+@dataclass(frozen=True)
 class BeamCalc:
+    """One beam, read through a one-row BeamBatch so scalar and batch agree."""
     circumference: float
     shoe_count: int
     boot_final: float
     rise: float
     shoe_size: float = SHOE_SIZE
     
+    @cached_property
+    def _row(self) -> dict:
+        # only the row is kept; the one-row batch behind it is dropped
+        return BeamBatch([self.circumference], [self.shoe_count], [self.boot_final],
+                         [self.rise], [self.shoe_size]).rows()[0]
+    
     @property
     def run(self) -> float:
-        return (self.shoe_count * self.shoe_size) + self.boot_final
+        return self._row["run"]
     
     @property
     def beam_length(self) -> float:
-        return pythagorean(self.run, self.rise) if self.rise else self.run
+        return self._row["beam_length"]
     
     @property
     def band_length(self) -> float:
-        return self.circumference + 8  # +7" bander grab +1" clip
+        return self._row["band_length"]
     
     @property
     def band_qty(self) -> int:
-        return math.ceil(self.beam_length / 40) + 1
+        return self._row["band_qty"]
     
     @property
     def mesh_length(self) -> float:
-        return self.circumference + 19  # +12" corners +3" overlap +4" edge
+        return self._row["mesh_length"]
     
     @property
     def mesh_qty(self) -> int:
-        return max(self.band_qty - 1, 1)
+        return self._row["mesh_qty"]
+    
+    def as_dict(self) -> dict:
+        return dict(self._row)
     
     def report(self) -> str:
         beam_type = "Angled" if self.rise else "Horizontal"
@@ -165,7 +1055,7 @@ Rise:           {self.rise}"
 {'-'*50}
 BEAM LENGTH:    {self.beam_length:.2f}" ({self.beam_length/12:.2f} ft)
 {'-'*50}
-Band Length:    {self.band_length}" (circ + 8")
+Band Length:    {self.band_length}" (circ + {BAND_ALLOWANCE}")
 Band Qty:       {self.band_qty}
 Total Band:     {self.band_qty * self.band_length}" ({self.band_qty * self.band_length/12:.2f} ft)
 {'-'*50}
@@ -177,11 +1067,272 @@ Total Mesh:     {self.mesh_qty * self.mesh_length * 40:.0f} sq in ({self.mesh_qt
 """
 
 
+def _beam_key(circumference, shoe_count, boot_final=0.0, rise=0.0, shoe_size=SHOE_SIZE) -> tuple:
+    return float(circumference), int(shoe_count), float(boot_final), float(rise), float(shoe_size)
+
+
+@result_cache("beam", _beam_key)
+def beam_calc(circumference, shoe_count, boot_final=0.0, rise=0.0, shoe_size=SHOE_SIZE) -> BeamCalc:
+    """Shared BeamCalc for a repeated profile; derived values are computed once."""
+    calc = BeamCalc(*_beam_key(circumference, shoe_count, boot_final, rise, shoe_size))
+    calc._row  # built now, so the cache charges for it
+    return calc
+
+
+# ============================================================
+# CUTTING STOCK
+# ============================================================
+
+CUT_TICKS = 8  # cut lengths are planned in 1/8" steps; pieces round up, stock rounds down
+
+
+@dataclass
+class CutPlan:
+    material: str
+    stock: float
+    method: str
+    patterns: List[Tuple[int, Tuple[Tuple[float, int], ...]]]  # (rolls cut this way, ((length, qty), ...))
+    lower_bound: int
+    solve_s: float
+    
+    @property
+    def rolls(self) -> int:
+        return sum(n for n, _ in self.patterns)
+    
+    @property
+    def tail(self) -> float:
+        """Offcut of the roll cut last (the largest one), which stays on the reel as stock."""
+        return max((self.stock - sum(length * qty for length, qty in cuts) for _, cuts in self.patterns),
+                   default=0.0)
+    
+    @property
+    def waste(self) -> float:
+        """Every offcut, the tail included."""
+        used = sum(n * sum(length * qty for length, qty in cuts) for n, cuts in self.patterns)
+        return self.rolls * self.stock - used
+    
+    @property
+    def waste_pct(self) -> float:
+        return self.waste / (self.rolls * self.stock) * 100 if self.rolls else 0.0
+    
+    @property
+    def waste_excl_tail(self) -> float:
+        return self.waste - self.tail
+    
+    @property
+    def waste_excl_tail_pct(self) -> float:
+        return self.waste_excl_tail / (self.rolls * self.stock) * 100 if self.rolls else 0.0
+    
+    def as_dict(self) -> dict:
+        return {
+            "material": self.material, "stock": self.stock, "method": self.method,
+            "rolls": self.rolls, "lower_bound": self.lower_bound,
+            "waste_in": self.waste, "waste_pct": self.waste_pct, "tail_in": self.tail,
+            "waste_excl_tail_in": self.waste_excl_tail, "waste_excl_tail_pct": self.waste_excl_tail_pct,
+            "solve_s": self.solve_s,
+            "patterns": [{"count": n, "cuts": [list(c) for c in cuts],
+                          "offcut": self.stock - sum(length * qty for length, qty in cuts)}
+                         for n, cuts in self.patterns],
+        }
+    
+    def report(self) -> str:
+        lines = [f"{self.material.upper():<5} {self.rolls} x {self.stock:g}\" stock   "
+                 f"waste {self.waste:,.1f}\" ({self.waste_pct:.1f}%), "
+                 f"{self.waste_excl_tail:,.1f}\" ({self.waste_excl_tail_pct:.1f}%) excl. {self.tail:g}\" tail   "
+                 f"lower bound {self.lower_bound}   {self.method} {self.solve_s:.3f}s"]
+        for n, cuts in self.patterns:
+            pieces = "  ".join(f"{length:g}\" x {qty}" for length, qty in cuts)
+            offcut = self.stock - sum(length * qty for length, qty in cuts)
+            lines.append(f"  x{n:<5} {pieces}   offcut {offcut:g}\"")
+        return "\n".join(lines)
+
+
+def _first_fit_decreasing(demand: dict, cap: int) -> List[List[int]]:
+    """FFD over a max segment tree of remaining capacity: O(pieces log rolls).
+    
+    Equal pieces go into the first roll with room as a run, not one by one.
+    """
+    pieces = sum(demand.values())
+    size = 1 << max(pieces - 1, 0).bit_length()
+    tree = [0] * size + [cap] * pieces + [0] * (size - pieces)
+    for i in range(size - 1, 0, -1):
+        tree[i] = max(tree[2 * i], tree[2 * i + 1])
+    
+    rolls = []
+    for length in sorted(demand, reverse=True):
+        left = demand[length]
+        while left:
+            i = 1
+            while i < size:
+                i = 2 * i if tree[2 * i] >= length else 2 * i + 1
+            b = i - size
+            if b == len(rolls):
+                rolls.append([])
+            qty = min(left, tree[i] // length)
+            rolls[b] += [length] * qty
+            left -= qty
+            tree[i] -= qty * length
+            while i > 1:
+                i //= 2
+                tree[i] = max(tree[2 * i], tree[2 * i + 1])
+    return rolls
+
+
+def _best_pattern(values: List[float], lengths: List[int], limits: List[int], cap: int,
+                  node_limit: int = 20000) -> Tuple[float, List[int], bool]:
+    """Bounded knapsack by branch and bound: max sum(values*a), sum(lengths*a) <= cap.
+    
+    Returns (value, counts, proven); proven is False if the node limit cut the search.
+    """
+    items = sorted((i for i in range(len(values)) if values[i] > 1e-12),
+                   key=lambda i: values[i] / lengths[i], reverse=True)
+    best_val, best, cur, nodes = 0.0, [0] * len(values), [0] * len(values), 0
+    
+    def bound(k: int, room: int) -> float:
+        total = 0.0
+        for i in items[k:]:
+            take = min(limits[i], room // lengths[i])
+            total += take * values[i]
+            room -= take * lengths[i]
+            if take < limits[i]:
+                return total + values[i] * room / lengths[i]
+        return total
+    
+    def dfs(k: int, room: int, val: float):
+        nonlocal best_val, best, nodes
+        if val > best_val + 1e-12:
+            best_val, best = val, cur[:]
+        if k == len(items) or nodes > node_limit or val + bound(k, room) <= best_val + 1e-12:
+            return
+        nodes += 1
+        i = items[k]
+        for qty in range(min(limits[i], room // lengths[i]), -1, -1):
+            cur[i] = qty
+            dfs(k + 1, room - qty * lengths[i], val + qty * values[i])
+        cur[i] = 0
+    
+    dfs(0, cap, 0.0)
+    return best_val, best, nodes <= node_limit
+
+
+def _column_generation(demand: dict, cap: int, deadline: float):
+    """Gilmore-Gomory LP relaxation by revised simplex with knapsack pricing.
+    
+    Returns (basis patterns with LP counts, LP bound or None if the budget ran
+    out or pricing was not proven optimal).
+    """
+    lengths = sorted(demand, reverse=True)
+    m = len(lengths)
+    d = [demand[length] for length in lengths]
+    patterns = []
+    for i in range(m):
+        col = [0] * m
+        col[i] = min(cap // lengths[i], d[i])
+        patterns.append(col)
+    basis = list(range(m))  # >= 0: pattern index, < 0: surplus column -(j + 1)
+    binv = [[1 / patterns[i][i] if i == j else 0.0 for j in range(m)] for i in range(m)]
+    x = [d[i] / patterns[i][i] for i in range(m)]
+    
+    converged = False
+    while time.perf_counter() < deadline:
+        cost = [1.0 if b >= 0 else 0.0 for b in basis]
+        y = [sum(cost[k] * binv[k][j] for k in range(m)) for j in range(m)]
+        value, col, proven = _best_pattern(y, lengths, d, cap)
+        enter, reduced = None, -1e-9
+        if 1 - value < reduced:
+            enter, reduced = col, 1 - value
+        j = min(range(m), key=y.__getitem__)
+        if y[j] < reduced:
+            enter, reduced = -(j + 1), y[j]
+        if enter is None:
+            converged = proven
+            break
+        
+        column = enter if isinstance(enter, list) else [-(i == -enter - 1) for i in range(m)]
+        direction = [sum(binv[k][i] * column[i] for i in range(m) if column[i]) for k in range(m)]
+        ratios = [(x[k] / direction[k], k) for k in range(m) if direction[k] > 1e-12]
+        if not ratios:
+            break
+        _, r = min(ratios)
+        pivot = direction[r]
+        binv[r] = [v / pivot for v in binv[r]]
+        x[r] /= pivot
+        for k in range(m):
+            if k != r and direction[k]:
+                f = direction[k]
+                binv[k] = [a - f * b for a, b in zip(binv[k], binv[r])]
+                x[k] -= f * x[r]
+        if isinstance(enter, list):
+            patterns.append(enter)
+            enter = len(patterns) - 1
+        basis[r] = enter
+    
+    lp = sum(x[k] for k in range(m) if basis[k] >= 0)
+    used = [(patterns[b], x[k]) for k, b in enumerate(basis) if b >= 0 and x[k] > 1e-9]
+    return lengths, used, (math.ceil(lp - 1e-6) if converged else None)
+
+
+def _patterns(rolls: List[List[int]]) -> List[Tuple[int, Tuple[Tuple[float, int], ...]]]:
+    counted = collections.Counter(
+        tuple((length / CUT_TICKS, qty) for length, qty in sorted(collections.Counter(roll).items(), reverse=True))
+        for roll in rolls
+    )
+    return sorted(((n, cuts) for cuts, n in counted.items()), key=lambda p: (-p[0], p[1]))
+
+
+def optimize_cuts(material: str, pieces: dict, stock: float, time_budget: float = 0.0) -> CutPlan:
+    """Cut `pieces` ({length: qty}, inches) from rolls of `stock` inches.
+    
+    First-fit decreasing always runs. With a time budget, column generation
+    then refines the LP bound and rounds its patterns down, finishing the
+    remainder with FFD; the better plan wins. Stops early once a plan meets
+    the lower bound.
+    """
+    started = time.perf_counter()
+    cap = int(stock * CUT_TICKS + 1e-9)
+    demand = collections.Counter()
+    for length, qty in pieces.items():
+        ticks = math.ceil(length * CUT_TICKS - 1e-9)
+        if ticks > cap:
+            raise ValueError(f"{material}: {length}\" piece is longer than {stock}\" stock")
+        demand[ticks] += qty
+    
+    rolls = _first_fit_decreasing(demand, cap)
+    method = "ffd"
+    lower = math.ceil(sum(t * q for t, q in demand.items()) / cap - 1e-9) if demand else 0
+    
+    if time_budget > 0 and len(rolls) > lower:
+        lengths, used, lp_bound = _column_generation(demand, cap, started + time_budget)
+        lower = max(lower, lp_bound or 0)
+        left = dict(demand)
+        rounded = []
+        for pattern, x in used:
+            for _ in range(int(x + 1e-9)):
+                roll = []
+                for length, qty in zip(lengths, pattern):
+                    take = min(qty, left[length])
+                    roll += [length] * take
+                    left[length] -= take
+                if roll:
+                    rounded.append(roll)
+        rounded += _first_fit_decreasing({k: v for k, v in left.items() if v}, cap)
+        if len(rounded) < len(rolls):
+            rolls, method = rounded, "cg"
+    
+    return CutPlan(material, stock, method, _patterns(rolls), lower, time.perf_counter() - started)
+
+
 # ============================================================
 # PIPE TRADES PRO FUNCTIONS
 # ============================================================
 
+def _angle_key(angle: float, offset: float) -> Tuple[float, float]:
+    return float(angle), float(offset)
+
+
+@result_cache("offset", _angle_key, copy=dict)
 def rolling_offset(angle: float, offset: float) -> dict:
+    angle, offset = _angle_key(angle, offset)  # later hits with 45 or 45.0 share this result
     rad = math.radians(angle)
     return {
         "angle": angle,
@@ -191,7 +1342,9 @@ def rolling_offset(angle: float, offset: float) -> dict:
     }
 
 
+@result_cache("cutback", _angle_key, copy=dict)
 def cutback(angle: float, offset: float) -> dict:
+    angle, offset = _angle_key(angle, offset)
     return {
         "angle": angle,
         "offset": offset,
@@ -212,76 +1365,2610 @@ def calibrate(satellite: float, field: float) -> dict:
 
 
 # ============================================================
-# CLI
+# BATCH I/O
 # ============================================================
 
-def main():
-    parser = argparse.ArgumentParser(description="Pipe Trades CLI")
-    sub = parser.add_subparsers(dest="cmd")
-    
-    # decode
-    p = sub.add_parser("decode")
-    p.add_argument("code")
-    
-    # beam
-    p = sub.add_parser("beam")
-    p.add_argument("--circ", type=float, required=True)
-    p.add_argument("--shoes", type=int, default=0)
-    p.add_argument("--boot", type=float, default=0)
-    p.add_argument("--rise", type=float, default=0)
+def parallel_ordered(fn, tasks, jobs: int, init=None, initargs=()):
+    """Yield (task, fn(task)) in input order, fanning out over `jobs` processes.
+
+    At most 2 * jobs tasks are in flight, so results never pile up in memory
+    ahead of a slow consumer. One job runs inline without a pool.
+    """
+    if jobs <= 1:
+        if init:
+            init(*initargs)
+        for task in tasks:
+            yield task, fn(task)
+        return
+    
+    with multiprocessing.Pool(jobs, init, initargs) as pool:
+        pending = collections.deque()
+        for task in itertools.chain(tasks, [None]):
+            if task is not None:
+                pending.append((task, pool.apply_async(fn, (task,))))
+            while pending and (task is None or len(pending) > 2 * jobs):
+                done, result = pending.popleft()
+                yield done, result.get()
+
+
+def open_input(path: str):
+    if path == "-":
+        return contextlib.nullcontext(sys.stdin)
+    return open(path, newline="", encoding="utf-8")
+
+
+def read_records(stream, fields: Tuple[str, ...], aliases: Tuple[str, ...] = ()) -> Iterator[dict]:
+    """Stream dicts from JSONL, headed CSV, or bare CSV/text lines.
+
+    A first row naming any of `fields` or `aliases` is a CSV header. Bare rows
+    map positionally onto `fields`; with a single field the whole line is the
+    value (Plus Codes with a locality contain commas).
+    """
+    for first in stream:
+        if first.strip():
+            break
+    else:
+        return
+    
+    if first.lstrip().startswith("{"):
+        for line in itertools.chain([first], stream):
+            if line.strip():
+                yield json.loads(line)
+        return
+    
+    header = [h.strip().lower() for h in next(csv.reader([first]))]
+    if any(h in fields or h in aliases for h in header):
+        for row in csv.reader(stream):
+            if row:
+                yield dict(zip(header, row))
+    elif len(fields) == 1:
+        for line in itertools.chain([first], stream):
+            line = line.strip()
+            if line:
+                yield {fields[0]: line}
+    else:
+        for row in csv.reader(itertools.chain([first], stream)):
+            if row:
+                yield dict(zip(fields, row))
+
+
+OUTPUT_FORMATS = ("json", "jsonl", "csv")
+
+
+class RecordWriter:
+    """Streams result dicts to a text stream as jsonl, one json array, or csv.
+
+    Records go straight to the stream; nothing is buffered beyond the csv
+    header. csv takes its columns from set_fields() or the first record, and
+    writes nested values as JSON.
+    """
+    
+    def __init__(self, out, fmt: str = "jsonl", header: Sequence[str] = None):
+        self.out, self.fmt, self.count = out, fmt, 0
+        self.fields = None
+        self._header = tuple(header) if header else None  # csv header already on the stream
+        self._csv = csv.writer(out, lineterminator="\n") if fmt == "csv" else None
+    
+    def set_fields(self, fields: Sequence[str]):
+        if self.count == 0:
+            self.fields = tuple(fields)
+    
+    def _open(self, rec: dict):
+        if self.fmt == "json":
+            self.out.write("[\n")
+        elif self._csv:
+            self.fields = self.fields or tuple(rec)
+            if self.fields != self._header:
+                self._csv.writerow(self.fields)
+    
+    def write(self, rec: dict):
+        if not self.count:
+            self._open(rec)
+        if self._csv:
+            self._csv.writerow([json.dumps(v) if isinstance(v, (list, dict)) else v
+                                for v in map(rec.get, self.fields)])
+        else:
+            if self.count and self.fmt == "json":
+                self.out.write(",\n")
+            self.out.write(json.dumps(rec))
+            if self.fmt == "jsonl":
+                self.out.write("\n")
+        self.count += 1
+    
+    def write_columns(self, fields: Sequence[str], columns: Sequence[Sequence]):
+        """Parallel columns as records; csv writes the row tuples directly."""
+        if not self._csv or (self.count and self.fields != tuple(fields)):
+            for values in zip(*columns):
+                self.write(dict(zip(fields, values)))
+            return
+        if not self.count:
+            self.fields = tuple(fields)
+            if self.fields != self._header:
+                self._csv.writerow(self.fields)
+        self._csv.writerows(zip(*columns))
+        self.count += len(columns[0])
+    
+    def close(self):
+        if self.fmt == "json":
+            self.out.write("\n]\n" if self.count else "[]\n")
+    
+    def __enter__(self):
+        return self
+    
+    def __exit__(self, exc_type, *exc):
+        if exc_type is None:  # a failed command must not look like an empty result
+            self.close()
+
+
+def report_throughput(label: str, count: int, errors: int, started: float):
+    elapsed = max(time.perf_counter() - started, 1e-9)
+    print(f"{label} {count} ({errors} errors) in {elapsed:.2f}s "
+          f"- {count / elapsed:,.0f}/s", file=sys.stderr)
+
+
+def decode_batch(stream, out: RecordWriter, chunk: int = 4096) -> Tuple[int, int]:
+    count = errors = 0
+    out.set_fields(("code", "south", "west", "north", "east", "lat", "lon", "error"))
+    records = (rec.get("code") or rec.get("location") or ""
+               for rec in read_records(stream, ("code",), ("location",)))
+    while True:
+        codes = list(itertools.islice(records, chunk))
+        if not codes:
+            return count, errors
+        areas = decode_plus_codes(codes)
+        for i, code in enumerate(codes):
+            if areas.valid(i):
+                out.write({"code": code, **areas[i].as_dict()})
+            else:
+                out.write({"code": code, "error": "invalid plus code"})
+                errors += 1
+        count += len(codes)
+
+
+def _point(rec: dict):
+    try:
+        return float(rec["lat"]), float(rec["lon"])
+    except (KeyError, TypeError, ValueError):
+        return None
+
+
+def encode_batch(stream, out: RecordWriter, length: int, near: str = None,
+                 chunk: int = 4096) -> Tuple[int, int]:
+    count = errors = 0
+    out.set_fields(("lat", "lon", "code", "short", "error") if near else ("lat", "lon", "code", "error"))
+    records = read_records(stream, ("lat", "lon"))
+    while True:
+        recs = list(itertools.islice(records, chunk))
+        if not recs:
+            return count, errors
+        points = [_point(rec) for rec in recs]
+        valid = [p for p in points if p]
+        codes = iter(encode_plus_codes([p[0] for p in valid], [p[1] for p in valid], length))
+        for rec, point in zip(recs, points):
+            if not point:
+                out.write({"lat": rec.get("lat"), "lon": rec.get("lon"), "error": "invalid lat/lon"})
+                errors += 1
+                continue
+            result = {"lat": point[0], "lon": point[1], "code": next(codes)}
+            if near:
+                result["short"] = shorten_plus_code(result["code"], near)
+            out.write(result)
+        count += len(recs)
+
+
+POINT_SPEC = re.compile(r"^\s*(-?\d+(?:\.\d*)?)\s*,\s*(-?\d+(?:\.\d*)?)\s*$")
+
+
+def parse_point(spec: str) -> Tuple[float, float]:
+    """'lat,lon' or a Plus Code (short codes need a locality)."""
+    m = POINT_SPEC.match(spec)
+    if m:
+        return float(m.group(1)), float(m.group(2))
+    area = decode_plus_code(spec)
+    return area.lat, area.lon
+
+
+def _located(rec: dict, i: int):
+    """(id, lat, lon) from a lat/lon or code record; None if unusable."""
+    point = _point(rec)
+    if point is None and rec.get("code"):
+        try:
+            point = parse_point(rec["code"])
+        except (IndexError, ValueError):
+            point = None
+    if point is None:
+        return None
+    return rec.get("id") or rec.get("name") or str(i), point[0], point[1]
+
+
+def read_points(stream) -> Iterator[Tuple[str, float, float]]:
+    for i, rec in enumerate(read_records(stream, ("lat", "lon"), ("code", "id", "name"))):
+        located = _located(rec, i)
+        if located is None:
+            raise ValueError(f"row {i + 1}: need lat,lon or code")
+        yield located
+
+
+def distance_one_to_many(origin: Tuple[float, float], stream, out: RecordWriter, unit: str,
+                         engine: str = "haversine", chunk: int = 4096) -> int:
+    count = 0
+    out.set_fields(("id", "lat", "lon", "distance", "unit"))
+    points = read_points(stream)
+    while True:
+        rows = list(itertools.islice(points, chunk))
+        if not rows:
+            return count
+        pts = PointSet(array("d", (r[1] for r in rows)), array("d", (r[2] for r in rows)))
+        dists = geodesic_many(*origin, pts, unit, engine)
+        for (pid, lat, lon), d in zip(rows, dists):
+            out.write({"id": pid, "lat": lat, "lon": lon, "distance": d, "unit": unit})
+        count += len(rows)
+
+
+# Matrix tiles: each worker holds the column PointSet (sent once through the
+# pool initializer) and turns a band of rows into one encoded block, so the
+# parent only ever holds a bounded window of finished bands.
+
+_matrix_cols = None
+
+
+def _matrix_init(lat: array, lon: array, unit: str, dtype: str, engine: str, grid: LocalGrid = None):
+    global _matrix_cols
+    if grid:
+        use_local_grid(grid)
+    _matrix_cols = (PointSet(lat, lon), unit, dtype, GEODESIC_ENGINES[engine][1])
+
+
+def _matrix_band(rows) -> bytes:
+    cols, unit, dtype, many = _matrix_cols
+    if dtype == "csv":
+        return "".join(
+            f"{pid},{','.join(map('{:.3f}'.format, many(lat, lon, cols, unit)))}\n"
+            for pid, lat, lon in rows
+        ).encode()
+    code = "f" if dtype == "f4" else "d"
+    return b"".join(array(code, many(lat, lon, cols, unit)).tobytes() for _, lat, lon in rows)
+
+
+def distance_matrix(row_stream, col_stream, out, unit: str, dtype: str = "csv",
+                    tile: int = 64, jobs: int = 0, engine: str = "haversine") -> Tuple[int, int]:
+    """Stream an N x M matrix in row-major tiles; rows are never all in memory.
+
+    csv writes an id column and a header of column ids; f4/f8 write raw
+    native-order float32/float64 rows.
+    """
+    cols = list(read_points(col_stream))
+    lat, lon = array("d", (c[1] for c in cols)), array("d", (c[2] for c in cols))
+    if dtype == "csv":
+        out.write(("id," + ",".join(str(c[0]) for c in cols) + "\n").encode())
+    
+    rows = read_points(row_stream)
+    bands = iter(lambda: list(itertools.islice(rows, tile)), [])
+    grid = local_grid() if engine == "local" else None
+    n = 0
+    for band, block in parallel_ordered(_matrix_band, bands, jobs or os.cpu_count() or 1,
+                                        _matrix_init, (lat, lon, unit, dtype, engine, grid)):
+        out.write(block)
+        n += len(band)
+    return n, len(cols)
+
+
+BEAM_TOTALS = ("beam_length", "band_qty", "total_band_in", "mesh_qty", "total_mesh_sqft")
+
+
+def _beam_row(rec: dict) -> BeamCalc:
+    def get(*keys, default=0):
+        return next((rec[k] for k in keys if rec.get(k) not in (None, "")), default)
+    circ = get("circ", "circumference", default=None)
+    if circ is None:
+        raise ValueError("missing circ")
+    circ, boot, rise = float(circ), float(get("boot", "boot_final")), float(get("rise"))
+    if not all(map(math.isfinite, (circ, boot, rise))):
+        raise ValueError("circ, boot and rise must be finite")
+    shoes = get("shoes", "shoe_count")
+    if not float(shoes).is_integer():  # int() would truncate 4.9 to 4
+        raise ValueError(f"shoes must be a whole number, got {shoes!r}")
+    return beam_calc(circ, int(float(shoes)), boot, rise)
+
+
+def _beam_chunk(task) -> Tuple[List[dict], dict]:
+    start, recs = task
+    beams, errors = [], {}
+    for i, rec in enumerate(recs):
+        try:
+            beams.append(_beam_row(rec))
+        except (TypeError, ValueError) as e:
+            errors[i] = str(e)
+    
+    batch = BeamBatch(*(
+        [getattr(b, name) for b in beams]
+        for name in ("circumference", "shoe_count", "boot_final", "rise", "shoe_size")
+    ))
+    rows = iter(batch.rows())
+    results = [{"row": start + i, "error": errors[i]} if i in errors else {"row": start + i, **next(rows)}
+               for i in range(len(recs))]
+    return results, {key: sum(getattr(batch, key)) for key in BEAM_TOTALS}
+
+
+def beam_batch(stream, out: RecordWriter, jobs: int = 0, chunk: int = 2048) -> Tuple[int, int]:
+    """Per-row takeoff as JSONL, then one {"row": "total", ...} record.
+
+    Chunks go to worker processes once the input is larger than one chunk;
+    output order always follows input order.
+    """
+    records = read_records(stream, ("circ", "shoes", "boot", "rise"),
+                           ("circumference", "shoe_count", "boot_final"))
+    chunks = iter(lambda: list(itertools.islice(records, chunk)), [])
+    first = next(chunks, [])
+    jobs = 1 if len(first) < chunk else (jobs or os.cpu_count() or 1)
+    tasks = ((1 + i * chunk, recs) for i, recs in enumerate(itertools.chain([first], chunks)))
+    
+    count = errors = 0
+    totals = dict.fromkeys(BEAM_TOTALS, 0)
+    out.set_fields(("row", *BEAM_COLUMNS, "error", "beams", "total_band_ft"))
+    for _, (results, sums) in parallel_ordered(_beam_chunk, tasks, jobs):
+        for r in results:
+            out.write(r)
+        count += len(results)
+        errors += sum("error" in r for r in results)
+        for key in BEAM_TOTALS:
+            totals[key] += sums[key]
+    out.write({"row": "total", "beams": count - errors, **totals,
+                      "total_band_ft": totals["total_band_in"] / 12})
+    return count, errors
+
+
+def cut_demand(stream, chunk: int = 4096) -> Tuple[dict, dict, dict]:
+    """({band length: qty}, {mesh length: qty}, {row: error}) aggregated over a beam file.
+    
+    Rows that fail as they would in beam --batch are left out of the demand.
+    """
+    bands, mesh, errors = collections.Counter(), collections.Counter(), {}
+    records = read_records(stream, ("circ", "shoes", "boot", "rise"),
+                           ("circumference", "shoe_count", "boot_final"))
+    row = 0
+    for recs in iter(lambda: list(itertools.islice(records, chunk)), []):
+        beams = []
+        for rec in recs:
+            row += 1
+            try:
+                beams.append(_beam_row(rec))
+            except (TypeError, ValueError) as e:
+                errors[row] = str(e)
+        batch = BeamBatch(*([getattr(b, name) for b in beams]
+                            for name in ("circumference", "shoe_count", "boot_final", "rise", "shoe_size")))
+        for length, qty in zip(batch.band_length, batch.band_qty):
+            bands[length] += qty
+        for length, qty in zip(batch.mesh_length, batch.mesh_qty):
+            mesh[length] += qty
+    return bands, mesh, errors
+
+
+def nearest_rank(ranked: Sequence[float], p: float) -> float:
+    """p-th percentile of an already sorted, non-empty sequence."""
+    return ranked[max(min(len(ranked) - 1, math.ceil(p / 100 * len(ranked)) - 1), 0)]
+
+
+SWEEP_METRICS = ("beam_length", "band_qty", "total_band_in", "mesh_qty", "total_mesh_sqft")
+SWEEP_PERCENTILES = (5, 25, 50, 75, 95)
+
+
+def value_range(text: str) -> List[float]:
+    """'44', '40:60:2' (inclusive, step defaults to 1) or '0,12,30'."""
+    try:
+        if ":" in text:
+            start, stop, *step = (float(v) for v in text.split(":"))
+            step = step[0] if step else 1.0
+            if step <= 0 or stop < start:
+                raise ValueError
+            return [round(start + i * step, 9) for i in range(int((stop - start) / step + 1e-9) + 1)]
+        return [float(v) for v in text.split(",")]
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"invalid value or range: {text!r}") from None
+
+
+def count_range(text: str) -> List[int]:
+    """value_range for counts: every value must be a whole number."""
+    values = value_range(text)
+    if any(v != int(v) for v in values):
+        raise argparse.ArgumentTypeError(f"whole numbers only: {text!r}")
+    return [int(v) for v in values]
+
+
+def positive_int(text: str) -> int:
+    """argparse type for sizes and counts that must be at least 1."""
+    try:
+        value = int(text)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"not a whole number: {text!r}") from None
+    if value < 1:
+        raise argparse.ArgumentTypeError(f"must be at least 1: {text!r}")
+    return value
+
+
+def sweep_batches(grid, chunk: int = 65536) -> Iterator[BeamBatch]:
+    points = itertools.product(*grid)
+    for rows in iter(lambda: list(itertools.islice(points, chunk)), []):
+        yield BeamBatch(*zip(*rows))
+
+
+def beam_sweep(grid, out: RecordWriter) -> int:
+    count = 0
+    for batch in sweep_batches(grid):
+        out.write_columns(BEAM_COLUMNS, [getattr(batch, name) for name in BEAM_COLUMNS])
+        count += len(batch)
+    return count
+
+
+def beam_sweep_summary(grid, out: RecordWriter) -> int:
+    """One record per material metric; columns are kept only for the percentiles."""
+    values = {}
+    for batch in sweep_batches(grid):
+        for metric in SWEEP_METRICS:
+            col = getattr(batch, metric)
+            values.setdefault(metric, array(col.typecode)).extend(col)
+    out.set_fields(("metric", "count", "min", "mean", *(f"p{p}" for p in SWEEP_PERCENTILES), "max"))
+    for metric, col in values.items():
+        ranked = sorted(col)
+        if not ranked:
+            continue
+        summary = {"metric": metric, "count": len(ranked), "min": ranked[0], "mean": math.fsum(ranked) / len(ranked)}
+        for p in SWEEP_PERCENTILES:
+            summary[f"p{p}"] = nearest_rank(ranked, p)
+        summary["max"] = ranked[-1]
+        out.write(summary)
+    return len(values.get(SWEEP_METRICS[0], ()))
+
+
+# ============================================================
+# JOB STORE
+# ============================================================
+
+JOBS_DIR = os.environ.get("PTC_JOBS", "jobs")
+JOB_READERS = ("list", "show", "query", "near", "diagnostics", "totals")  # jobs actions that never append
+JOURNAL_MAGIC = b"PTCJRN1\0"
+JOURNAL_INDEX_MAGIC = b"PTCJIX1\0"
+_RECORD = struct.Struct("<II")  # payload bytes, crc32(payload)
+
+
+# Journal payloads are either compact JSON (first byte "{") or a version-1
+# binary record for the job shape beam_wizard() saves:
+#   <BIBH10d  version, flags, timestamp bytes, location bytes, then lat, lon,
+#             the 4 inputs and the 4 outputs as doubles
+#   timestamp and location UTF-8, then any other top-level keys as a
+#   compact JSON object.
+# Flags mark which of the 10 numbers were ints and which were null, so the
+# decoded job re-serializes to exactly the JSON it was made from; encode_job
+# checks that and stores JSON whenever it would not.
+
+JOB_CODEC = os.environ.get("PTC_JOB_CODEC", "binary")  # for new saves: binary or json
+JOB_CODECS = ("binary", "json")
+_JOB_V1 = struct.Struct("<BIBH10d")
+_JOB_INPUTS = ("circumference", "shoes", "boot", "rise")
+_JOB_OUTPUTS = ("beam_length", "band_qty", "mesh_panels", "total_mesh_sqft")
+_JOB_V1_KEYS = frozenset(("timestamp", "location", "lat", "lon", "inputs", "outputs"))
+_NULLS, _NO_POINT, _NO_LOCATION = 10, 1 << 20, 1 << 21  # null flags start at bit 10
+
+
+def _compact_json(value) -> bytes:
+    return json.dumps(value, separators=(",", ":"), ensure_ascii=False).encode()
+
+
+def _encode_job_v1(job: dict) -> bytes:
+    inputs, outputs = job["inputs"], job["outputs"]
+    if tuple(inputs) != _JOB_INPUTS or tuple(outputs) != _JOB_OUTPUTS:
+        raise ValueError("not the beam job schema")
+    flags = 0 if "lat" in job else _NO_POINT
+    values = [job.get("lat"), job.get("lon"), *inputs.values(), *outputs.values()]
+    for i, v in enumerate(values):
+        if v is None:
+            flags |= 1 << (_NULLS + i)
+            values[i] = 0.0
+        elif type(v) is int:
+            flags |= 1 << i
+        elif type(v) is not float:
+            raise TypeError(f"{v!r} is not a number")
+    stamp, location = job["timestamp"].encode(), job["location"]
+    if location is None:
+        flags |= _NO_LOCATION
+    location = (location or "").encode()
+    extras = {k: v for k, v in job.items() if k not in _JOB_V1_KEYS}
+    return b"".join((_JOB_V1.pack(1, flags, len(stamp), len(location), *values), stamp, location,
+                     _compact_json(extras) if extras else b""))
+
+
+def decode_job(payload: bytes) -> dict:
+    """A journal payload back to the job dict, whichever encoding it is in."""
+    head = payload[:1]
+    if head == b"{":
+        return json.loads(payload)
+    if head != b"\x01":
+        raise ValueError(f"unsupported job record version {head[0] if head else None}")
+    try:
+        _, flags, m, n, *v = _JOB_V1.unpack_from(payload)
+    except struct.error:
+        raise ValueError("truncated job record") from None
+    pos = _JOB_V1.size + m
+    stamp, location = payload[_JOB_V1.size:pos].decode(), payload[pos:pos + n].decode()
+    bits = flags & 0xFFFFF
+    while bits:  # only the set flags: typically two ints
+        low = bits & -bits
+        i = low.bit_length() - 1
+        v[i - _NULLS] = None if i >= _NULLS else int(v[i])
+        bits ^= low
+    job = {"timestamp": stamp, "location": None if flags & _NO_LOCATION else location}
+    if not flags & _NO_POINT:
+        job["lat"], job["lon"] = v[0], v[1]
+    job["inputs"] = {"circumference": v[2], "shoes": v[3], "boot": v[4], "rise": v[5]}
+    job["outputs"] = {"beam_length": v[6], "band_qty": v[7], "mesh_panels": v[8], "total_mesh_sqft": v[9]}
+    pos += n
+    if pos < len(payload):
+        job.update(json.loads(payload[pos:]))
+    return job
+
+
+def encode_job(job: dict, codec: str = JOB_CODEC) -> bytes:
+    """Journal payload for a job: binary when it round-trips exactly, compact JSON otherwise."""
+    text = _compact_json(job)
+    if codec == "binary":
+        try:
+            blob = _encode_job_v1(job)
+        except (KeyError, TypeError, ValueError, AttributeError, OverflowError, struct.error):
+            return text
+        if _compact_json(decode_job(blob)) == text:
+            return blob
+    return text
+
+
+_FRAME = struct.Struct("<I")
+
+
+def pack_jobs(jobs: Sequence[dict]) -> bytes:
+    """Length-prefixed encode_job() records, without store ids: the /sync/jobs body."""
+    return b"".join(_FRAME.pack(len(p)) + p for p in
+                    (encode_job({k: v for k, v in job.items() if k != "id"}) for job in jobs))
+
+
+def unpack_jobs(data: bytes) -> List[dict]:
+    jobs, pos = [], 0
+    while pos < len(data):
+        if pos + 4 > len(data):
+            raise ValueError("truncated job frame")
+        (n,) = _FRAME.unpack_from(data, pos)
+        if pos + 4 + n > len(data):
+            raise ValueError("truncated job frame")
+        jobs.append(decode_job(data[pos + 4:pos + 4 + n]))
+        pos += 4 + n
+    return jobs
+
+
+def _write_all(f, data: bytes):
+    view = memoryview(data)
+    while view:
+        view = view[f.write(view):]
+
+
+class JobJournal:
+    """Append-only job store in `root`.
+    
+    journal.bin holds length-prefixed, CRC-checked encode_job() records; journal.idx
+    is a flat array of their offsets, so job i (its sequence number, which is
+    its id) and any page of jobs are one seek away. The index is derived data:
+    opening or appending re-indexes records past the last indexed one and cuts
+    a torn tail left by a crash.
+    
+    Appends are group-committed: concurrent callers queue their records and
+    whichever finds no commit running writes them all with one fsync.
+    
+    A read-only journal creates nothing and leaves recovery to the next
+    writer; opening one where no store exists raises FileNotFoundError.
+    """
+    
+    def __init__(self, root: str = JOBS_DIR, codec: str = JOB_CODEC, readonly: bool = False):
+        self.root, self.codec = root, codec
+        if not readonly:
+            os.makedirs(root, exist_ok=True)
+        self.path = os.path.join(root, "journal.bin")
+        self.index_path = os.path.join(root, "journal.idx")
+        self._log = self._open(self.path, JOURNAL_MAGIC, readonly)
+        self._idx = self._open(self.index_path, JOURNAL_INDEX_MAGIC, readonly)
+        self._read_lock = threading.Lock()
+        self._cond = threading.Condition()
+        self._pending = []
+        self._committing = False
+        if not readonly:
+            with self._exclusive():
+                self._recover()
+    
+    @staticmethod
+    def _open(path: str, magic: bytes, readonly: bool = False):
+        f = open(path, "rb" if readonly else "a+b", buffering=0)
+        f.seek(0)
+        head = f.read(len(magic))
+        if not head and not readonly:
+            _write_all(f, magic)
+        elif head != magic:
+            f.close()
+            raise ValueError(f"{path}: not a job journal")
+        return f
+    
+    @contextlib.contextmanager
+    def _exclusive(self):
+        """Serialize writers across processes (no-op where flock is missing)."""
+        if fcntl is None:
+            yield
+            return
+        fcntl.flock(self._log.fileno(), fcntl.LOCK_EX)
+        try:
+            yield
+        finally:
+            fcntl.flock(self._log.fileno(), fcntl.LOCK_UN)
+    
+    def _read(self, f, offset: int, size: int) -> bytes:
+        with self._read_lock:
+            f.seek(offset)
+            return f.read(size)
+    
+    def _offsets(self, start: int, stop: int) -> array:
+        offsets = array("Q")
+        offsets.frombytes(self._read(self._idx, len(JOURNAL_INDEX_MAGIC) + 8 * start, 8 * (stop - start)))
+        return offsets
+    
+    def _recover(self):
+        n, size = len(self), os.fstat(self._log.fileno()).st_size
+        end = len(JOURNAL_MAGIC)
+        while n:
+            last = self._offsets(n - 1, n)[0]
+            head = self._read(self._log, last, _RECORD.size)
+            if len(head) == _RECORD.size and last + _RECORD.size + _RECORD.unpack(head)[0] <= size:
+                end = last + _RECORD.size + _RECORD.unpack(head)[0]
+                break
+            n -= 1
+        if end == size and n == len(self):
+            return
+        
+        tail, found, pos = self._read(self._log, end, size - end), array("Q"), 0
+        while pos + _RECORD.size <= len(tail):
+            length, crc = _RECORD.unpack_from(tail, pos)
+            payload = tail[pos + _RECORD.size:pos + _RECORD.size + length]
+            if len(payload) < length or zlib.crc32(payload) != crc:
+                break
+            found.append(end + pos)
+            pos += _RECORD.size + length
+        self._log.truncate(end + pos)
+        self._idx.truncate(len(JOURNAL_INDEX_MAGIC) + 8 * n)
+        _write_all(self._idx, found.tobytes())
+    
+    def __len__(self) -> int:
+        return (os.fstat(self._idx.fileno()).st_size - len(JOURNAL_INDEX_MAGIC)) // 8
+    
+    def encode(self, job: dict) -> bytes:
+        return encode_job(job, self.codec)
+    
+    def _write(self, payloads: List[bytes]) -> int:
+        with self._exclusive():
+            self._recover()
+            first, pos = len(self), os.fstat(self._log.fileno()).st_size
+            frames, offsets = [], array("Q")
+            for payload in payloads:
+                offsets.append(pos)
+                frames += (_RECORD.pack(len(payload), zlib.crc32(payload)), payload)
+                pos += _RECORD.size + len(payload)
+            _write_all(self._log, b"".join(frames))
+            os.fsync(self._log.fileno())
+            _write_all(self._idx, offsets.tobytes())  # rebuilt from the journal if lost
+        return first
+    
+    def append(self, job: dict) -> int:
+        return self.append_many([job])[0]
+    
+    def append_many(self, jobs) -> List[int]:
+        """Durably append jobs, returning their ids once fsync'd."""
+        entry = [[self.encode(job) for job in jobs], None]
+        with self._cond:
+            self._pending.append(entry)
+            while entry[1] is None:
+                if self._committing:
+                    self._cond.wait()
+                    continue
+                batch, self._pending = self._pending, []
+                self._committing = True
+                self._cond.release()
+                try:
+                    first = self._write([p for e in batch for p in e[0]])
+                    for e in batch:
+                        e[1], first = list(range(first, first + len(e[0]))), first + len(e[0])
+                except Exception as exc:
+                    for e in batch:
+                        e[1] = exc
+                finally:
+                    self._cond.acquire()
+                    self._committing = False
+                    self._cond.notify_all()
+        if isinstance(entry[1], Exception):
+            raise entry[1]
+        return entry[1]
+    
+    def page(self, start: int, count: int) -> List[dict]:
+        """Jobs start..start+count-1 (clipped), each with its "id"."""
+        n = len(self)
+        start, stop = max(start, 0), min(start + count, n)
+        if start >= stop:
+            return []
+        offsets = self._offsets(start, min(stop + 1, n))
+        end = offsets[-1] if stop < n else os.fstat(self._log.fileno()).st_size
+        blob = self._read(self._log, offsets[0], end - offsets[0])
+        jobs, pos = [], 0
+        for i in range(start, stop):
+            length, crc = _RECORD.unpack_from(blob, pos)
+            payload = blob[pos + _RECORD.size:pos + _RECORD.size + length]
+            if zlib.crc32(payload) != crc:
+                raise ValueError(f"{self.path}: job {i} failed its checksum")
+            jobs.append({"id": i, **decode_job(payload)})
+            pos += _RECORD.size + length
+        return jobs
+    
+    def get_many(self, ids: Sequence[int]) -> Iterator[dict]:
+        """Jobs by id, in the order given; one index read for the whole span."""
+        if not len(ids):
+            return
+        n, lo, hi = len(self), min(ids), max(ids)
+        if lo < 0 or hi >= n:
+            raise IndexError(f"no job {lo if lo < 0 else hi}")
+        offsets = self._offsets(lo, min(hi + 2, n))
+        size = os.fstat(self._log.fileno()).st_size
+        for i in ids:
+            start = offsets[i - lo]
+            end = offsets[i - lo + 1] if i + 1 < n else size
+            blob = self._read(self._log, start, end - start)
+            length, crc = _RECORD.unpack_from(blob)
+            payload = blob[_RECORD.size:_RECORD.size + length]
+            if zlib.crc32(payload) != crc:
+                raise ValueError(f"{self.path}: job {i} failed its checksum")
+            yield {"id": i, **decode_job(payload)}
+    
+    def __getitem__(self, i: int) -> dict:
+        found = self.page(i + len(self) if i < 0 else i, 1)
+        if not found:
+            raise IndexError(f"no job {i}")
+        return found[0]
+    
+    def scan(self, start: int = 0, chunk: int = 4096) -> Iterator[dict]:
+        for first in range(start, len(self), chunk):
+            yield from self.page(first, chunk)
+    
+    def import_legacy(self, paths: Sequence[str], chunk: int = 1024) -> int:
+        """Append one-file-per-job JSON documents (the old jobs/job_*.json)."""
+        count = 0
+        for i in range(0, len(paths), chunk):
+            jobs = []
+            for path in paths[i:i + chunk]:
+                with open(path) as f:
+                    jobs.append(json.load(f))
+            count += len(self.append_many(jobs))
+        return count
+    
+    def close(self):
+        self._log.close()
+        self._idx.close()
+    
+    def __enter__(self):
+        return self
+    
+    def __exit__(self, *exc):
+        self.close()
+
+
+def _job_epoch(job: dict) -> float:
+    return datetime.fromisoformat(job["timestamp"]).timestamp()
+
+
+def job_point(job: dict) -> Tuple[float, float]:
+    """Saved coordinates, or the location text decoded (jobs saved before coordinates were kept)."""
+    if job.get("lat") is not None and job.get("lon") is not None:
+        return float(job["lat"]), float(job["lon"])
+    return parse_point(job["location"])
+
+
+SPATIAL_CELL = PAIR_RESOLUTIONS[3]  # 8-digit Plus Code cell, ~275 m of latitude
+_CELL_COLUMNS = round(2 * LONGITUDE_MAX / SPATIAL_CELL)
+
+
+def spatial_cell(lat: float, lon: float) -> int:
+    """Row-major number of the 8-digit Plus Code cell holding a point."""
+    row = min(int((lat + LATITUDE_MAX) / SPATIAL_CELL), round(2 * LATITUDE_MAX / SPATIAL_CELL) - 1)
+    col = int((lon + LONGITUDE_MAX) / SPATIAL_CELL) % _CELL_COLUMNS
+    return row * _CELL_COLUMNS + col
+
+
+JOB_COLUMNS = {
+    "timestamp": _job_epoch,
+    "circumference": lambda job: job["inputs"]["circumference"],
+    "shoes": lambda job: job["inputs"]["shoes"],
+    "boot": lambda job: job["inputs"]["boot"],
+    "rise": lambda job: job["inputs"]["rise"],
+    "beam_length": lambda job: job["outputs"]["beam_length"],
+    "band_qty": lambda job: job["outputs"]["band_qty"],
+    "mesh_panels": lambda job: job["outputs"]["mesh_panels"],
+    "total_mesh_sqft": lambda job: job["outputs"]["total_mesh_sqft"],
+    "lat": lambda job: job_point(job)[0],
+    "lon": lambda job: job_point(job)[1],
+    "cell": lambda job: spatial_cell(*job_point(job)),
+}
+
+
+class JobIndex:
+    """Secondary indexes over a JobJournal, kept in STORE/index/.
+    
+    Each column is two flat arrays: <name>.col, the value of every job by id
+    (NaN when missing), and <name>.ord, the ids with a value sorted by it. A
+    range filter is two bisects on .ord; other filters check .col per
+    candidate. Locations are dictionary-encoded the same way. New jobs are
+    appended to the columns and merged into the orderings on refresh().
+    meta.json keeps the digest of the last indexed job and the length of
+    every ordering; if either no longer matches (the store was replaced, or
+    a refresh died midway) the index is rebuilt.
+    """
+    
+    LOCATION = "location"
+    
+    def __init__(self, journal: JobJournal):
+        self.journal = journal
+        self.dir = os.path.join(journal.root, "index")
+        self._read_meta()
+    
+    def _read_meta(self):
+        self._cols, self._ords = {}, {}
+        try:
+            with open(os.path.join(self.dir, "meta.json")) as f:
+                meta = json.load(f)
+        except (OSError, ValueError):
+            meta = {}
+        self.count = meta.get("count", 0) if meta.get("columns") == sorted(JOB_COLUMNS) else 0
+        self._sizes = meta.get("sizes", {})
+        if self.count and not self._intact(meta.get("last")):
+            self.count = 0
+        self.locations = meta.get("locations", []) if self.count else []
+    
+    def _intact(self, last: str) -> bool:
+        if self.count > len(self.journal) or job_digest(self.journal[self.count - 1]) != last:
+            return False
+        try:
+            for name in (*JOB_COLUMNS, self.LOCATION):
+                width = 4 if name == self.LOCATION else 8
+                if (os.path.getsize(os.path.join(self.dir, f"{name}.col")) < width * self.count
+                        or os.path.getsize(os.path.join(self.dir, f"{name}.ord")) != 4 * self._sizes[name]):
+                    return False
+        except (OSError, KeyError):
+            return False
+        return True
+    
+    def _load(self, name: str, kind: str) -> array:
+        cache = self._cols if kind == "col" else self._ords
+        if name not in cache:
+            col = array("d" if kind == "col" and name != self.LOCATION else "I")
+            if self.count:
+                with open(os.path.join(self.dir, f"{name}.{kind}"), "rb") as f:
+                    # a .col may run past count if a refresh died before meta.json
+                    col.frombytes(f.read(col.itemsize * self.count) if kind == "col" else f.read())
+            cache[name] = col
+        return cache[name]
+    
+    def column(self, name: str) -> array:
+        return self._load(name, "col")
+    
+    def ordering(self, name: str) -> array:
+        return self._load(name, "ord")
+    
+    def refresh(self) -> int:
+        """Index jobs saved since the last refresh; returns how many."""
+        if self.count == len(self.journal):
+            return 0
+        os.makedirs(self.dir, exist_ok=True)
+        with open(os.path.join(self.dir, "lock"), "a") as lock:
+            if fcntl is not None:
+                fcntl.flock(lock.fileno(), fcntl.LOCK_EX)
+            self._read_meta()  # another process may have got here first
+            return self._extend(list(self.journal.scan(self.count)))
+    
+    def _extend(self, jobs: List[dict]) -> int:
+        if not jobs:
+            return 0
+        start = self.count
+        codes = {loc: i for i, loc in enumerate(self.locations)}
+        for name in (*JOB_COLUMNS, self.LOCATION):
+            col, ord_ = self.column(name), self.ordering(name)
+            if name == self.LOCATION:
+                col.extend(codes.setdefault(job.get("location") or "", len(codes)) for job in jobs)
+            else:
+                get = JOB_COLUMNS[name]
+                for job in jobs:
+                    try:
+                        col.append(float(get(job)))
+                    except (KeyError, TypeError, ValueError, IndexError):
+                        col.append(math.nan)
+            fresh = [job["id"] for job in jobs if col[job["id"]] == col[job["id"]]]
+            # both runs are already sorted, so this is a merge
+            self._ords[name] = array("I", sorted(itertools.chain(ord_, sorted(fresh, key=col.__getitem__)),
+                                                 key=col.__getitem__))
+        self.locations = list(codes)
+        self.count += len(jobs)
+        self._save(start, job_digest(jobs[-1]))
+        return len(jobs)
+    
+    def _save(self, start: int, last: str):
+        """Append the new rows to each .col; rewrite only the orderings that gained ids."""
+        for name, values in self._cols.items():
+            with open(os.path.join(self.dir, f"{name}.col"), "r+b" if start else "wb") as f:
+                f.truncate(values.itemsize * start)
+                f.seek(0, os.SEEK_END)
+                values[start:].tofile(f)
+        for name, values in self._ords.items():
+            if start and len(values) == self._sizes.get(name):
+                continue
+            tmp = os.path.join(self.dir, f"{name}.ord.tmp")
+            with open(tmp, "wb") as f:
+                values.tofile(f)
+            os.replace(tmp, os.path.join(self.dir, f"{name}.ord"))
+        self._sizes = {name: len(values) for name, values in self._ords.items()}
+        tmp = os.path.join(self.dir, "meta.json.tmp")
+        with open(tmp, "w") as f:
+            json.dump({"count": self.count, "last": last, "columns": sorted(JOB_COLUMNS),
+                       "locations": self.locations, "sizes": self._sizes}, f)
+        os.replace(tmp, os.path.join(self.dir, "meta.json"))
+    
+    def _span(self, name: str, lo: float, hi: float) -> Tuple[int, int]:
+        """Positions in .ord holding lo <= value <= hi."""
+        col, ord_ = self.column(name), self.ordering(name)
+        key = col.__getitem__
+        return bisect.bisect_left(ord_, lo, key=key), bisect.bisect_right(ord_, hi, key=key)
+    
+    def query(self, ranges: dict, location: str = None, order: str = None,
+              desc: bool = False, limit: int = None) -> List[int]:
+        """Ids of jobs with every ranges[name] = (lo, hi) bound met (inclusive).
+        
+        The narrowest range drives the scan; location is a case-insensitive
+        substring of the saved location text. Results are by id unless
+        `order` names a column.
+        """
+        candidates = [(name, *self._span(name, lo, hi)) for name, (lo, hi) in ranges.items()]
+        codes = None
+        if location is not None:
+            needle = location.lower()
+            codes = {i for i, loc in enumerate(self.locations) if needle in loc.lower()}
+            locs = self.column(self.LOCATION)
+        
+        if candidates:
+            name, start, stop = min(candidates, key=lambda c: c[2] - c[1])
+            ids = self.ordering(name)[start:stop]
+            checks = [(self.column(n), *ranges[n]) for n in ranges if n != name]
+        else:
+            ids, checks = range(self.count), []
+        if checks or codes is not None:
+            ids = [i for i in ids
+                   if all(lo <= col[i] <= hi for col, lo, hi in checks)
+                   and (codes is None or locs[i] in codes)]
+        
+        if order:
+            key = self.column(order).__getitem__
+            ids = sorted((i for i in ids if key(i) == key(i)), key=key, reverse=desc)
+        else:
+            ids = sorted(ids, reverse=desc)
+        return ids[:limit] if limit else ids
+    
+    def near(self, lat: float, lon: float, radius_ft: float) -> List[Tuple[int, float]]:
+        """(id, feet) of jobs within radius_ft of a point, nearest first.
+        
+        Candidates come from the cell ordering, one bisected run of cells per
+        cell row the radius touches; haversine only refines that shortlist.
+        Longitude spans are not wrapped across the antimeridian.
+        """
+        dlat = math.degrees(radius_ft / R_FT)
+        edge = min(abs(lat) + dlat, 89.9)
+        dlon = min(dlat / math.cos(math.radians(edge)), LONGITUDE_MAX)
+        c0 = spatial_cell(lat - dlat, max(lon - dlon, -LONGITUDE_MAX))
+        c1 = spatial_cell(lat + dlat, min(lon + dlon, LONGITUDE_MAX - 1e-9))
+        (r0, col0), (r1, col1) = divmod(c0, _CELL_COLUMNS), divmod(c1, _CELL_COLUMNS)
+        cells = self.ordering("cell")
+        ids = array("I")
+        for row in range(r0, r1 + 1):
+            start, stop = self._span("cell", row * _CELL_COLUMNS + col0, row * _CELL_COLUMNS + col1)
+            ids.extend(cells[start:stop])
+        if not ids:
+            return []
+        lats, lons = self.column("lat"), self.column("lon")
+        points = PointSet(array("d", map(lats.__getitem__, ids)), array("d", map(lons.__getitem__, ids)))
+        found = [(i, d) for i, d in zip(ids, haversine_many(lat, lon, points)) if d <= radius_ft]
+        return sorted(found, key=lambda hit: (hit[1], hit[0]))
+
+
+QUERY_FILTER = re.compile(r"^\s*(\w+)\s*(<=|>=|==|=|<|>)\s*(.+?)\s*$")
+
+
+def parse_when(text: str) -> float:
+    """Epoch seconds from an ISO date/time or a relative '7d' / '12h' / '30m' ago."""
+    m = re.fullmatch(r"(\d+(?:\.\d+)?)([dhm])", text.strip())
+    if m:
+        unit = {"d": 86400, "h": 3600, "m": 60}[m.group(2)]
+        return time.time() - float(m.group(1)) * unit
+    return datetime.fromisoformat(text.strip()).timestamp()
+
+
+def parse_filter(text: str) -> Tuple[str, float, float]:
+    """'beam_length>60', 'circumference=44', 'rise=0..12' -> (column, lo, hi)."""
+    m = QUERY_FILTER.match(text)
+    if not m or m.group(1) not in JOB_COLUMNS:
+        raise ValueError(f"bad filter {text!r} (columns: {', '.join(JOB_COLUMNS)})")
+    name, op, raw = m.groups()
+    value = parse_when if name == "timestamp" else float
+    if op in ("=", "==") and ".." in raw:
+        lo, hi = raw.split("..", 1)
+        return name, value(lo), value(hi)
+    v = value(raw)
+    # strict bounds step to the next representable float
+    return name, *{"<": (-math.inf, math.nextafter(v, -math.inf)), "<=": (-math.inf, v),
+                   ">": (math.nextafter(v, math.inf), math.inf), ">=": (v, math.inf),
+                   "=": (v, v), "==": (v, v)}[op]
+
+
+SAVE_STATS_SAMPLES = 10000  # latencies kept in STORE/save_stats.json
+
+
+class JobWriter:
+    """Background saver in front of a JobJournal.
+    
+    submit() only enqueues; it blocks solely when `depth` saves are already
+    waiting. One thread drains everything queued into a single append_many,
+    i.e. one write and one fsync per batch. close(), also registered to run
+    at exit, drains the queue first, so a clean exit never drops a save.
+    """
+    
+    def __init__(self, journal: JobJournal, depth: int = 256):
+        self.journal = journal
+        # recent samples only, as many as save_stats.json keeps
+        self.enqueue_s, self.durable_s, self.batches = (collections.deque(maxlen=SAVE_STATS_SAMPLES)
+                                                        for _ in range(3))
+        self._queue = queue.Queue(depth)
+        self._closed = False
+        self._thread = threading.Thread(target=self._run, name="job-writer", daemon=True)
+        self._thread.start()
+        atexit.register(self.close)
+    
+    def submit(self, job: dict) -> Future:
+        """Queue a save; the future resolves to the job id once it is on disk."""
+        if self._closed:
+            raise ValueError("job writer is closed")
+        started, future = time.perf_counter(), Future()
+        self._queue.put((job, future, started))
+        self.enqueue_s.append(time.perf_counter() - started)
+        return future
+    
+    def _run(self):
+        stop = False
+        while not stop:
+            batch = [self._queue.get()]
+            while len(batch) < self._queue.maxsize:
+                try:
+                    batch.append(self._queue.get_nowait())
+                except queue.Empty:
+                    break
+            stop = None in batch
+            saves = [item for item in batch if item is not None]
+            if saves:
+                self._commit(saves)
+            for _ in batch:
+                self._queue.task_done()
+    
+    def _commit(self, saves):
+        try:
+            ids = self.journal.append_many([job for job, _, _ in saves])
+        except Exception as e:
+            for _, future, _ in saves:
+                future.set_exception(e)
+            return
+        done = time.perf_counter()
+        for (_, future, started), i in zip(saves, ids):
+            self.durable_s.append(done - started)
+            future.set_result(i)
+        self.batches.append(len(saves))
+    
+    def flush(self):
+        """Block until every save submitted so far is durable."""
+        self._queue.join()
+    
+    def close(self):
+        if self._closed:
+            return
+        self._closed = True
+        atexit.unregister(self.close)
+        self._queue.put(None)
+        self._thread.join()
+        self._save_stats()
+    
+    def _save_stats(self):
+        if not self.batches:
+            return
+        path = os.path.join(self.journal.root, "save_stats.json")
+        try:
+            with open(path) as f:
+                stats = json.load(f)
+        except (OSError, ValueError):
+            stats = {}
+        for key, new in (("enqueue_s", self.enqueue_s), ("durable_s", self.durable_s), ("batches", self.batches)):
+            stats[key] = (stats.get(key, []) + list(new))[-SAVE_STATS_SAMPLES:]
+        tmp = path + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump(stats, f)
+        os.replace(tmp, path)
+
+
+def save_diagnostics(journal: JobJournal) -> dict:
+    """Store size and index lag, plus save latency percentiles from recent JobWriter sessions."""
+    try:
+        with open(os.path.join(journal.root, "save_stats.json")) as f:
+            stats = json.load(f)
+    except (OSError, ValueError):
+        stats = {}
+    report = {
+        "store": journal.root, "jobs": len(journal),
+        "journal_bytes": os.path.getsize(journal.path),
+        "unindexed": len(journal) - JobIndex(journal).count,
+    }
+    for key in ("enqueue", "durable"):
+        ranked = sorted(stats.get(f"{key}_s", []))
+        report[f"{key}_samples"] = len(ranked)
+        for p in (50, 90, 99, 100):
+            report[f"{key}_p{p}_ms" if p < 100 else f"{key}_max_ms"] = \
+                nearest_rank(ranked, p) * 1000 if ranked else None
+    batches = stats.get("batches", [])
+    report["batches"] = len(batches)
+    report["mean_batch"] = sum(batches) / len(batches) if batches else None
+    report["max_batch"] = max(batches, default=None)
+    return report
+
+
+TOTALS_GROUPS = ("day", "location", "crew")
+TOTALS_FIELDS = ("jobs", "band_ft", "mesh_sqft", "beam_ft")
+
+
+def job_materials(job: dict) -> Tuple[float, float, float]:
+    """(band ft, mesh sq ft, beam ft) of a saved beam job; bands are cut as BeamBatch.band_length."""
+    inputs, outputs = job.get("inputs", {}), job.get("outputs", {})
+    band_in = (outputs.get("band_qty") or 0) * ((inputs.get("circumference") or 0) + BAND_ALLOWANCE)
+    return band_in / 12, outputs.get("total_mesh_sqft") or 0.0, (outputs.get("beam_length") or 0) / 12
+
+
+class JobTotals:
+    """Running material totals per day, location and crew, checkpointed in STORE/totals.json.
+    
+    update() folds in only the jobs saved after the checkpoint's cursor. The
+    checkpoint also keeps the digest of the last job it counted; if that job
+    no longer matches (the store was replaced or rebuilt) it starts over.
+    """
+    
+    def __init__(self, journal: JobJournal):
+        self.journal = journal
+        self.path = os.path.join(journal.root, "totals.json")
+        try:
+            with open(self.path) as f:
+                state = json.load(f)
+        except (OSError, ValueError):
+            state = {}
+        self.cursor, self.last = state.get("cursor", 0), state.get("last")
+        self.groups = {g: state.get("groups", {}).get(g, {}) for g in TOTALS_GROUPS}
+        if self.cursor and (self.cursor > len(journal) or job_digest(journal[self.cursor - 1]) != self.last):
+            self.cursor, self.last = 0, None
+            self.groups = {g: {} for g in TOTALS_GROUPS}
+    
+    @staticmethod
+    def keys(job: dict) -> Tuple[str, str, str]:
+        return (str(job.get("timestamp") or "")[:10] or "-", str(job.get("location") or "-"),
+                str(job.get("crew") or "-"))
+    
+    def update(self, chunk: int = 4096) -> set:
+        """Count jobs appended since the last update; returns the (group, key) pairs that changed."""
+        changed, total = set(), len(self.journal)
+        while self.cursor < total:
+            jobs = self.journal.page(self.cursor, min(chunk, total - self.cursor))
+            for job in jobs:
+                band, mesh, beam = job_materials(job)
+                for group, key in zip(TOTALS_GROUPS, self.keys(job)):
+                    row = self.groups[group].setdefault(key, dict.fromkeys(TOTALS_FIELDS, 0))
+                    row["jobs"] += 1
+                    row["band_ft"] += band
+                    row["mesh_sqft"] += mesh
+                    row["beam_ft"] += beam
+                    changed.add((group, key))
+            self.cursor += len(jobs)
+            self.last = job_digest(jobs[-1])
+        if changed:
+            with open(self.path + ".tmp", "w") as f:
+                json.dump({"cursor": self.cursor, "last": self.last, "groups": self.groups}, f)
+            os.replace(self.path + ".tmp", self.path)
+        return changed
+    
+    def rows(self, group: str, keys=None) -> List[dict]:
+        table = self.groups[group]
+        return [{group: key, **table[key]} for key in sorted(table if keys is None else keys,
+                                                               reverse=group == "day")]
+
+
+_IN_MODIFY = 0x2
+
+
+class StoreWatcher:
+    """Waits for a file to change: inotify on Linux, size/mtime polling elsewhere (iSH, macOS, Windows)."""
+    
+    def __init__(self, path: str, interval: float = 1.0):
+        self.path, self.interval, self._fd = path, interval, None
+        try:
+            libc = ctypes.CDLL(None, use_errno=True)
+            fd = libc.inotify_init1(os.O_NONBLOCK | os.O_CLOEXEC)
+            if fd >= 0 and libc.inotify_add_watch(fd, os.fsencode(path), _IN_MODIFY) >= 0:
+                self._fd = fd
+            elif fd >= 0:
+                os.close(fd)
+        except (OSError, AttributeError, TypeError):
+            pass
+        self.mode = "inotify" if self._fd is not None else "polling"
+        self._stamp = self._stat()
+    
+    def _stat(self) -> tuple:
+        st = os.stat(self.path)
+        return st.st_size, st.st_mtime_ns
+    
+    def wait(self, timeout: float = None) -> bool:
+        """True once the file changed, False if `timeout` seconds passed first."""
+        if self._fd is not None:
+            ready = select.select([self._fd], [], [], timeout)[0]
+            with contextlib.suppress(BlockingIOError):
+                while os.read(self._fd, 65536):
+                    pass
+            return bool(ready)
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            stamp = self._stat()
+            if stamp != self._stamp:
+                self._stamp = stamp
+                return True
+            if deadline is not None and time.monotonic() >= deadline:
+                return False
+            time.sleep(self.interval if deadline is None else max(min(self.interval, deadline - time.monotonic()), 0))
+    
+    def close(self):
+        if self._fd is not None:
+            os.close(self._fd)
+            self._fd = None
+
+
+JOB_FIELDS = ("id", "timestamp", "location", "crew", "lat", "lon", "inputs", "outputs")
+
+
+def job_summary(job: dict) -> str:
+    inputs, outputs = job.get("inputs", {}), job.get("outputs", {})
+    return (f"#{job['id']:<6} {job.get('timestamp', '')[:19]:<19}  "
+            f"circ {inputs.get('circumference', 0):>5g}\"  beam {outputs.get('beam_length', 0):>7.2f}\"  "
+            f"{job.get('location') or '-'}")
+
+
+# ============================================================
+# COLUMNAR EXPORT
+# ============================================================
+
+COLUMNS_MAGIC = b"PTCCOL1\0"
+_COLUMNS_TAIL = struct.Struct("<Q8s")  # footer bytes, magic
+_COLUMN_TYPES = {"float64": "d", "int64": "q", "bool": "B"}
+
+
+def iter_records(paths: Sequence[str]) -> Iterator[dict]:
+    """Records from JSON/JSONL files and directories of them, e.g. recon/data/."""
+    for path in paths:
+        if os.path.isdir(path):
+            yield from iter_records(sorted(glob.glob(os.path.join(path, "*.json")) +
+                                           glob.glob(os.path.join(path, "*.jsonl"))))
+            continue
+        with open(path, encoding="utf-8") as f:
+            if path.endswith(".jsonl"):
+                yield from (json.loads(line) for line in f if line.strip())
+            else:
+                data = json.load(f)
+                yield from data if isinstance(data, list) else [data]
+
+
+def flatten_record(record: dict, prefix: str = "", out: dict = None) -> dict:
+    """Nested objects become dotted columns: {"inputs": {"shoes": 4}} -> {"inputs.shoes": 4}."""
+    out = {} if out is None else out
+    for key, value in record.items():
+        if isinstance(value, dict) and value:
+            flatten_record(value, f"{prefix}{key}.", out)
+        else:
+            out[prefix + key] = value
+    return out
+
+
+def _column_type(values: list) -> str:
+    kinds = {type(v) for v in values if v is not None}
+    if kinds <= {bool}:
+        return "bool"
+    if kinds <= {int} and all(-2 ** 63 <= v < 2 ** 63 for v in values if v is not None):
+        return "int64"
+    if kinds <= {int, float}:
+        return "float64"
+    return "string" if kinds <= {str} else "json"
+
+
+def _column_stats(kind: str, values: list) -> dict:
+    present = [v for v in values if v is not None]
+    stats = {"count": len(present), "nulls": len(values) - len(present)}
+    if kind == "json":
+        present = [json.dumps(v) for v in present]
+    if kind in ("int64", "float64"):
+        finite = [v for v in present if v == v]
+        stats.update(min=min(finite, default=None), max=max(finite, default=None), sum=math.fsum(finite),
+                     mean=math.fsum(finite) / len(finite) if finite else None)
+    elif kind == "bool":
+        stats["true"] = sum(present)
+    else:
+        stats.update(min=min(present, default=None), max=max(present, default=None), distinct=len(set(present)))
+    return stats
+
+
+def write_columns(path: str, records, source: str = "") -> dict:
+    """Write records as a column file; returns its footer.
+    
+    Layout: magic, then one 8-byte-aligned little-endian buffer per column
+    piece, then a JSON footer listing every column's type, buffer offsets
+    and statistics, its length and the magic again. Numbers are float64 or
+    int64 arrays (null float -> NaN, plus a validity bitmap whenever a column
+    has nulls); strings are int32 codes into a dictionary when values repeat,
+    else int64 offsets into UTF-8 data. Readers map the file and touch only
+    the columns they ask for.
+    """
+    columns, rows = {}, 0
+    for record in records:
+        for key, value in flatten_record(record).items():
+            column = columns.get(key)
+            if column is None:
+                column = columns[key] = [None] * rows
+            column.append(value)
+        rows += 1
+        for column in columns.values():
+            if len(column) < rows:
+                column.append(None)
+    
+    footer = {"rows": rows, "source": source, "created": datetime.now().isoformat(timespec="seconds"),
+              "columns": []}
+    with open(path + ".tmp", "wb") as f:
+        f.write(COLUMNS_MAGIC)
+        
+        def put(data: bytes) -> list:
+            start = f.tell()
+            f.write(data)
+            f.write(b"\0" * (_align8(start + len(data)) - start - len(data)))
+            return [start, len(data)]
+        
+        for name, values in columns.items():
+            kind = _column_type(values)
+            meta = {"name": name, "type": kind, "buffers": {}, "stats": _column_stats(kind, values)}
+            buffers = meta["buffers"]
+            if meta["stats"]["nulls"]:
+                bits = bytearray((rows + 7) // 8)
+                for i, v in enumerate(values):
+                    if v is not None:
+                        bits[i >> 3] |= 1 << (i & 7)
+                buffers["validity"] = put(bytes(bits))
+            if kind in _COLUMN_TYPES:
+                fill = math.nan if kind == "float64" else 0
+                buffers["values"] = put(array(_COLUMN_TYPES[kind], (fill if v is None else v for v in values)).tobytes())
+            else:
+                text = [v if kind == "string" or v is None else json.dumps(v) for v in values]
+                distinct = list(dict.fromkeys(t for t in text if t is not None))
+                if len(distinct) * 2 <= rows:
+                    meta["encoding"] = "dictionary"
+                    code = {t: i for i, t in enumerate(distinct)}
+                    buffers["codes"] = put(array("i", (-1 if t is None else code[t] for t in text)).tobytes())
+                    text = distinct
+                blobs = [(t or "").encode() for t in text]
+                buffers["offsets"] = put(array("q", itertools.accumulate(map(len, blobs), initial=0)).tobytes())
+                buffers["data"] = put(b"".join(blobs))
+            footer["columns"].append(meta)
+        data = json.dumps(footer).encode()
+        f.write(data)
+        f.write(_COLUMNS_TAIL.pack(len(data), COLUMNS_MAGIC))
+    os.replace(path + ".tmp", path)
+    return footer
+
+
+class ColumnFile:
+    """Memory-mapped reader for write_columns() files.
+    
+    values() returns numeric columns as zero-copy memoryviews over the map
+    ("d", "q" or "B"), so a scan of one column reads only its pages;
+    buffer() gives the same bytes in np.frombuffer() argument order.
+    Release those views (and arrays) before close().
+    """
+    
+    def __init__(self, path: str):
+        if sys.byteorder != "little":
+            raise ValueError("column files are little-endian")
+        with open(path, "rb") as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        size, magic = _COLUMNS_TAIL.unpack_from(self._map, len(self._map) - _COLUMNS_TAIL.size)
+        if magic != COLUMNS_MAGIC or self._map[:len(COLUMNS_MAGIC)] != COLUMNS_MAGIC:
+            raise ValueError(f"{path}: not a column file")
+        end = len(self._map) - _COLUMNS_TAIL.size
+        self.meta = json.loads(self._map[end - size:end])
+        self.rows = self.meta["rows"]
+        self.columns = {c["name"]: c for c in self.meta["columns"]}
+    
+    def _buffer(self, column: dict, name: str, fmt: str = "B") -> memoryview:
+        start, length = column["buffers"][name]
+        return memoryview(self._map)[start:start + length].cast(fmt)
+    
+    def stats(self, name: str) -> dict:
+        return self.columns[name]["stats"]
+    
+    def buffer(self, name: str) -> Tuple[mmap.mmap, str, int, int]:
+        """(map, dtype, count, offset) of a numeric column: np.frombuffer(*f.buffer(name))."""
+        column = self.columns[name]
+        if column["type"] not in _COLUMN_TYPES:
+            raise ValueError(f"{name} is a {column['type']} column, not numeric")
+        start = column["buffers"]["values"][0]
+        dtype = {"float64": "<f8", "int64": "<i8", "bool": "u1"}[column["type"]]
+        return self._map, dtype, self.rows, start
+    
+    def values(self, name: str):
+        """A numeric column as a memoryview; strings and JSON as a list (None for nulls)."""
+        column = self.columns[name]
+        if column["type"] in _COLUMN_TYPES:
+            return self._buffer(column, "values", _COLUMN_TYPES[column["type"]])
+        offsets, data = self._buffer(column, "offsets", "q"), self._buffer(column, "data")
+        text = [str(data[offsets[i]:offsets[i + 1]], "utf-8") for i in range(len(offsets) - 1)]
+        if column.get("encoding") == "dictionary":
+            text = [None if c < 0 else text[c] for c in self._buffer(column, "codes", "i")]
+        valid = self.valid(name)
+        if valid is not None:
+            text = [t if ok else None for t, ok in zip(text, valid)]
+        if column["type"] == "json":
+            text = [None if t is None else json.loads(t) for t in text]
+        return text
+    
+    def valid(self, name: str):
+        """Per-row presence flags, or None when the column has no nulls."""
+        column = self.columns[name]
+        if "validity" not in column["buffers"]:
+            return None
+        bits = self._buffer(column, "validity")
+        return [bool(bits[i >> 3] >> (i & 7) & 1) for i in range(self.rows)]
+    
+    def close(self):
+        self._map.close()
+    
+    def __enter__(self):
+        return self
+    
+    def __exit__(self, *exc):
+        self.close()
+
+
+# ============================================================
+# CLI
+# ============================================================
+
+def add_grid_args(p: argparse.ArgumentParser):
+    p.add_argument("--grid", metavar="YAML", help="local engine: recon config with gps_bounds "
+                   "(default $PTC_GRID or recon/grok_config.yaml)")
+    p.add_argument("--origin", metavar="POINT", help="local engine: origin as a locality, lat,lon or Plus Code")
+    p.add_argument("--radius", type=float, default=0.05, help="local engine: bounds around --origin, degrees")
+
+
+def select_grid(args):
+    if args.origin:
+        found = find_locality(args.origin)
+        use_local_grid(LocalGrid.around(*(found[1] if found else parse_point(args.origin)), args.radius))
+    elif args.grid:
+        use_local_grid(LocalGrid.from_bounds(*read_gps_bounds(args.grid)))
+
+
+def warm_state():
+    """Load the default gazetteer and plant grid before serving many commands."""
+    gazetteer()
+    with contextlib.suppress(OSError):
+        local_grid()
+
+
+@contextlib.contextmanager
+def isolated_state():
+    """Undo --gazetteer / --origin / --grid when one of many commands finishes."""
+    global _gazetteer, _local_grid
+    state = _gazetteer, _local_grid
+    try:
+        yield
+    finally:
+        _gazetteer, _local_grid = state
+
+
+@cache
+def build_parser() -> argparse.ArgumentParser:
+    parser = argparse.ArgumentParser(description="Pipe Trades CLI")
+    parser.add_argument("--stdin", action="store_true",
+                        help="read one command per line from stdin, write jsonl results")
+    parser.add_argument("--cache-stats", action="store_true",
+                        help="print result-cache hit/miss/eviction counters to stderr on exit")
+    parser.add_argument("--format", choices=OUTPUT_FORMATS,
+                        help="machine-readable results (default: text, jsonl for batch/sweep)")
+    sub = parser.add_subparsers(dest="cmd")
+    # also accepted after the subcommand; SUPPRESS keeps it from resetting a global --format
+    common = argparse.ArgumentParser(add_help=False)
+    common.add_argument("--format", choices=OUTPUT_FORMATS, default=argparse.SUPPRESS,
+                        help="same as the global --format")
+    
+    # decode
+    p = sub.add_parser("decode", parents=[common])
+    p.add_argument("code", nargs="?")
+    p.add_argument("--batch", metavar="FILE", help="CSV/JSONL of codes, '-' for stdin")
+    p.add_argument("--gazetteer", metavar="FILE", help="built locality file (default $PTC_GAZETTEER)")
+    
+    # encode
+    p = sub.add_parser("encode", parents=[common])
+    p.add_argument("--lat", type=float)
+    p.add_argument("--lon", type=float)
+    p.add_argument("--length", type=int, default=PAIR_CODE_LENGTH, choices=(2, 4, 6, 8, 10, 11, 12, 13, 14, 15),
+                   help="digits, 11-15 add grid refinement")
+    p.add_argument("--near", metavar="LOCALITY", help="also print the short code relative to a locality")
+    p.add_argument("--batch", metavar="FILE", help="CSV/JSONL of lat,lon, '-' for stdin")
+    p.add_argument("--gazetteer", metavar="FILE", help="built locality file (default $PTC_GAZETTEER)")
+    
+    # gazetteer
+    p = sub.add_parser("gazetteer")
+    gsub = p.add_subparsers(dest="action", required=True)
+    g = gsub.add_parser("build", parents=[common], help="compile name,lat,lon rows into a memory-mappable file")
+    g.add_argument("source", help="CSV/JSONL of name,lat,lon, '-' for stdin")
+    g.add_argument("-o", "--output", default="gazetteer.bin")
+    g = gsub.add_parser("match", parents=[common], help="show which locality a text resolves to")
+    g.add_argument("text")
+    g.add_argument("--gazetteer", metavar="FILE", help="built locality file (default $PTC_GAZETTEER)")
+    
+    # distance
+    p = sub.add_parser("distance", parents=[common], help="point-to-point, one-to-many or N x M haversine")
+    p.add_argument("source", help="lat,lon / Plus Code, or a CSV/JSONL of points ('-' for stdin)")
+    p.add_argument("target", help="lat,lon / Plus Code, or a CSV/JSONL of points")
+    p.add_argument("--unit", default="ft", choices=sorted(UNIT_CONV))
+    p.add_argument("--engine", default="haversine", choices=sorted(GEODESIC_ENGINES),
+                   help="haversine (sphere), vincenty (WGS84 ellipsoid) or local (plant grid)")
+    add_grid_args(p)
+    p.add_argument("-o", "--output", help="matrix output file (default stdout)")
+    p.add_argument("--dtype", default="csv", choices=("csv", "f4", "f8"), help="matrix encoding")
+    p.add_argument("--tile", type=int, default=64, help="matrix rows per worker task")
+    p.add_argument("--jobs", type=int, default=0, help="matrix worker processes (default: all cores)")
+    
+    # beam
+    p = sub.add_parser("beam", parents=[common])
+    p.add_argument("mode", nargs="?", choices=("sweep",), help="sweep: evaluate every combination of ranges")
+    p.add_argument("--circ", type=value_range, help="value, or start:stop[:step] / a,b,c in sweep mode")
+    p.add_argument("--shoes", type=count_range, default=[0])
+    p.add_argument("--boot", type=value_range, default=[0.0])
+    p.add_argument("--rise", type=value_range, default=[0.0])
+    p.add_argument("--batch", metavar="FILE", help="CSV/JSONL of circ,shoes,boot,rise rows, '-' for stdin")
+    p.add_argument("--jobs", type=int, default=0, help="batch worker processes (default: all cores)")
+    p.add_argument("--summary", action="store_true", help="sweep: only min/percentiles/max of material totals")
+    
+    # optimize-cuts
+    p = sub.add_parser("optimize-cuts", parents=[common], help="cut plan for band coils and mesh rolls")
+    p.add_argument("beams", help="CSV/JSONL of circ,shoes,boot,rise rows, '-' for stdin")
+    p.add_argument("--band-stock", type=float, default=1200, help="band coil length, inches")
+    p.add_argument("--mesh-stock", type=float, default=1800, help="40\"-wide mesh roll length, inches")
+    p.add_argument("--time-budget", type=float, default=0,
+                   help="seconds for the column-generation solver (0 = first-fit decreasing only)")
     
     # offset
-    p = sub.add_parser("offset")
+    p = sub.add_parser("offset", parents=[common])
     p.add_argument("--angle", type=float, required=True)
     p.add_argument("--offset", type=float, required=True)
     
     # cutback
-    p = sub.add_parser("cutback")
+    p = sub.add_parser("cutback", parents=[common])
     p.add_argument("--angle", type=float, required=True)
     p.add_argument("--offset", type=float, required=True)
     
     # calibrate
-    p = sub.add_parser("calibrate")
-    p.add_argument("--satellite", type=float, required=True)
+    p = sub.add_parser("calibrate", parents=[common])
+    p.add_argument("--satellite", type=float)
+    p.add_argument("--from", dest="from_point", metavar="POINT", help="satellite distance from this point...")
+    p.add_argument("--to", dest="to_point", metavar="POINT", help="...to this one (lat,lon or Plus Code)")
+    p.add_argument("--engine", default="haversine", choices=sorted(GEODESIC_ENGINES))
+    add_grid_args(p)
     p.add_argument("--field", type=float, required=True)
     p.add_argument("--unit", default="ft")
     
     # hyp
-    p = sub.add_parser("hyp")
+    p = sub.add_parser("hyp", parents=[common])
     p.add_argument("--run", type=float, required=True)
     p.add_argument("--rise", type=float, required=True)
     
-    args = parser.parse_args()
+    # jobs
+    p = sub.add_parser("jobs", help="saved jobs journal: list, query, sync, ...")
+    jsub = p.add_subparsers(dest="action", required=True)
+    j = jsub.add_parser("list", parents=[common], help="newest first, one page at a time")
+    j.add_argument("--page", type=int, default=0)
+    j.add_argument("--per-page", type=positive_int, default=20)
+    j = jsub.add_parser("show", parents=[common])
+    j.add_argument("id", type=int)
+    j = jsub.add_parser("import", parents=[common], help="append legacy job_*.json files to the journal")
+    j.add_argument("files", nargs="*", help="default: STORE/job_*.json")
+    jsub.add_parser("diagnostics", parents=[common], help="store size, index lag and save latency percentiles")
+    j = jsub.add_parser("sync", parents=[common], help="push jobs saved since the last sync to a collector")
+    j.add_argument("url", help="collector base URL, e.g. http://collector:8081")
+    j.add_argument("--batch", type=positive_int, default=SYNC_BATCH, help="jobs per upload")
+    j.add_argument("--retries", type=int, default=3, help="retries per request, with backoff")
+    j.add_argument("--timeout", type=float, default=30.0, help="seconds per request")
+    j = jsub.add_parser("reconcile", parents=[common], help="exchange exactly the jobs two stores do not share")
+    j.add_argument("peer", help="another store directory or a `jobs collect` URL")
+    j.add_argument("--dry-run", action="store_true", help="only count the differences")
+    j.add_argument("--retries", type=int, default=3)
+    j.add_argument("--timeout", type=float, default=30.0)
+    j = jsub.add_parser("collect", help="receive `jobs sync` uploads into STORE")
+    j.add_argument("--host", default="0.0.0.0")
+    j.add_argument("--port", type=int, default=8081)
+    j = jsub.add_parser("totals", parents=[common], help="band, mesh and beam totals per day, location or crew")
+    j.add_argument("--by", choices=TOTALS_GROUPS, default="day")
+    j.add_argument("--watch", action="store_true", help="keep running; print groups as new jobs are saved")
+    j.add_argument("--interval", type=float, default=1.0, help="seconds between polls without inotify")
+    j = jsub.add_parser("near", parents=[common], help="jobs within a radius of a point, nearest first")
+    j.add_argument("point", help="locality, lat,lon or Plus Code")
+    j.add_argument("--radius", type=float, default=500)
+    j.add_argument("--unit", default="ft", choices=sorted(UNIT_CONV))
+    j.add_argument("--limit", type=int)
+    j = jsub.add_parser("query", parents=[common], help="filter saved jobs through the column indexes")
+    j.add_argument("filters", nargs="*", metavar="FILTER",
+                   help="COLUMN OP VALUE, e.g. beam_length>60 circumference=40..48 timestamp>=7d")
+    j.add_argument("--location", help="case-insensitive text in the saved location")
+    j.add_argument("--since", metavar="WHEN", help="ISO date/time or 7d / 12h ago")
+    j.add_argument("--until", metavar="WHEN")
+    j.add_argument("--order", choices=sorted(JOB_COLUMNS), help="sort by a column (default: saved order)")
+    j.add_argument("--desc", action="store_true")
+    j.add_argument("--limit", type=int)
+    j.add_argument("--ids", action="store_true", help="only print matching ids")
+    for j in jsub.choices.values():
+        j.add_argument("--store", default=JOBS_DIR, help="job store directory (default $PTC_JOBS or jobs/)")
+    
+    # export
+    p = sub.add_parser("export", parents=[common], help="saved jobs or recon records as records or a column file")
+    p.add_argument("sources", nargs="*", help="recon JSON/JSONL files or directories (default: the job store)")
+    p.add_argument("--store", default=JOBS_DIR, help="job store directory (default $PTC_JOBS or jobs/)")
+    p.add_argument("--columnar", action="store_true", help="write a memory-mappable column file with statistics")
+    p.add_argument("-o", "--output", help="column file (default jobs.ptcc or recon.ptcc)")
+    
+    # serve
+    p = sub.add_parser("serve", help="keep the calculators loaded behind a Unix socket")
+    p.add_argument("--socket", default=DAEMON_SOCKET, help="socket path (default $PTC_SOCKET)")
+    
+    # http
+    p = sub.add_parser("http", help="JSON calculation service (/beam, /offset, ..., /healthz, /readyz)")
+    p.add_argument("--host", default="0.0.0.0")
+    p.add_argument("--port", type=int, default=8080)
+    p.add_argument("--workers", type=int, default=0, help="worker processes (default: all cores)")
+    
+    return parser
+
+
+def main(argv: Sequence[str] = None):
+    parser = build_parser()
+    args = parser.parse_args(argv)
+    if args.cache_stats:
+        atexit.register(lambda: print(json.dumps(cache_stats()), file=sys.stderr))
+    
+    if args.stdin:
+        sys.exit(1 if run_lines(parser, sys.stdin, sys.stdout) else 0)
+    if args.cmd == "serve":
+        serve(args.socket)
+        return
+    if args.cmd == "http":
+        serve_http(args.host, args.port, args.workers)
+        return
+    if args.cmd == "jobs" and args.action == "collect":
+        serve_collector(args.store, args.host, args.port)
+        return
+    
+    # Batch commands always stream records; single results only when --format is given.
+    out = RecordWriter(sys.stdout, args.format or "jsonl") if args.cmd else None
+    with out or contextlib.nullcontext():
+        run(parser, args, out)
+
+
+SHELL_SYNTAX = re.compile(r"[\"'\\#]")
+
+
+def in_process_refusal(argv: Sequence[str]) -> str:
+    """Why a command line cannot run inside the daemon or --stdin ('' if it can).
+    
+    Servers and watchers never return and stdin readers would read the host's
+    own input, so either would hang every later request.
+    """
+    words = [a for a in argv if not a.startswith("-")]
+    if "-" in argv or "--stdin" in argv:
+        return "it reads stdin"
+    if words[:1] in (["serve"], ["http"]) or words[:2] == ["jobs", "collect"]:
+        return "it is a server"
+    if words[:2] == ["jobs", "totals"] and "--watch" in argv:
+        return "it runs until stopped"
+    return ""
+
+
+def run_lines(parser: argparse.ArgumentParser, stream, out) -> int:
+    """--stdin: each line is a subcommand, answered in order; returns the error count.
+
+    Results default to jsonl. A line that fails becomes {"line": n, "error": ...}
+    so output stays aligned with input. Consecutive csv lines with the same
+    columns share one header.
+    """
+    started = time.perf_counter()
+    count = errors = 0
+    header = None
+    warm_state()
+    for n, line in enumerate(stream, 1):
+        if not line.strip() or line.lstrip().startswith("#"):
+            continue
+        count += 1
+        stderr = io.StringIO()
+        try:
+            argv = shlex.split(line, comments=True) if SHELL_SYNTAX.search(line) else line.split()
+            with isolated_state(), contextlib.redirect_stderr(stderr):
+                refusal = in_process_refusal(argv)
+                if refusal:
+                    raise ValueError(f"'{line.strip()}' cannot run inside --stdin: {refusal}")
+                if "-h" in argv or "--help" in argv:
+                    raise ValueError("help is not available inside --stdin; run main.py -h")
+                args = parser.parse_args(argv)
+                args.format = args.format or "jsonl"
+                with RecordWriter(out, args.format, header) as writer:
+                    run(parser, args, writer)
+                if writer.fmt == "csv" and writer.count:
+                    header = writer.fields
+        except SystemExit:
+            message = stderr.getvalue().strip().splitlines()
+            RecordWriter(out).write({"line": n, "error": message[-1] if message else "invalid command"})
+            errors += 1
+        except Exception as e:
+            RecordWriter(out).write({"line": n, "error": str(e)})
+            errors += 1
+        else:
+            sys.stderr.write(stderr.getvalue())
+        out.flush()
+    report_throughput("Commands", count, errors, started)
+    return errors
+
+
+def run(parser: argparse.ArgumentParser, args, out: RecordWriter):
+    structured = args.format is not None
+    if getattr(args, "gazetteer", None):
+        use_gazetteer(args.gazetteer)
+    
+    if args.cmd == "decode" and args.batch:
+        started = time.perf_counter()
+        with open_input(args.batch) as f:
+            count, errors = decode_batch(f, out)
+        report_throughput("Decoded", count, errors, started)
     
-    if args.cmd == "decode":
+    elif args.cmd == "decode":
+        if not args.code:
+            parser.error("decode requires a code or --batch")
         area = decode_plus_code(args.code)
-        print(f"Lat: {area.lat:.6f}\nLon: {area.lon:.6f}")
-        print(f"https://maps.google.com/?q={area.lat},{area.lon}")
+        if structured:
+            out.write({"code": args.code, **area.as_dict()})
+        else:
+            print(f"Lat: {area.lat:.6f}\nLon: {area.lon:.6f}")
+            print(f"https://maps.google.com/?q={area.lat},{area.lon}")
+    
+    elif args.cmd == "encode" and args.batch:
+        started = time.perf_counter()
+        with open_input(args.batch) as f:
+            count, errors = encode_batch(f, out, args.length, args.near)
+        report_throughput("Encoded", count, errors, started)
+    
+    elif args.cmd == "encode":
+        if args.lat is None or args.lon is None:
+            parser.error("encode requires --lat and --lon, or --batch")
+        code = encode_plus_code(args.lat, args.lon, args.length)
+        short = shorten_plus_code(code, args.near) if args.near else None
+        if structured:
+            out.write({"lat": args.lat, "lon": args.lon, "code": code,
+                       **({"short": short} if args.near else {})})
+        else:
+            print(f"Code:  {code}")
+            if args.near:
+                print(f"Short: {short}")
+    
+    elif args.cmd == "gazetteer" and args.action == "build":
+        with open_input(args.source) as f:
+            rows = [(r["name"], r["lat"], r["lon"]) for r in read_records(f, ("name", "lat", "lon"))]
+        data = Gazetteer.build(rows)
+        with open(args.output, "wb") as f:
+            f.write(data)
+        if structured:
+            out.write({"localities": len(Gazetteer(data)), "bytes": len(data), "output": args.output})
+        else:
+            print(f"Built {len(Gazetteer(data))} localities ({len(data):,} bytes) -> {args.output}")
+    
+    elif args.cmd == "gazetteer":
+        found = find_locality(args.text)
+        if structured:
+            name, (lat, lon) = found or (None, (None, None))
+            out.write({"text": args.text, "locality": name, "lat": lat, "lon": lon})
+        elif found:
+            name, (lat, lon) = found
+            print(f"Locality: {name}\nLat: {lat:.6f}\nLon: {lon:.6f}")
+        else:
+            print("No locality matched.")
+    
+    elif args.cmd == "distance":
+        select_grid(args)
+        is_file = [spec == "-" or os.path.isfile(spec) for spec in (args.source, args.target)]
+        started = time.perf_counter()
+        if not any(is_file):
+            d = geodesic(*parse_point(args.source), *parse_point(args.target), args.unit, args.engine)
+            if structured:
+                out.write({"source": args.source, "target": args.target, "distance": d,
+                           "unit": args.unit, "engine": args.engine})
+            else:
+                print(f"Distance: {d:.2f} {args.unit}")
+        elif all(is_file):
+            if args.format is not None and not args.output:
+                parser.error("--format does not apply to a matrix on stdout; choose its encoding with --dtype")
+            dest = open(args.output, "wb") if args.output else contextlib.nullcontext(sys.stdout.buffer)
+            with open_input(args.source) as rows, open_input(args.target) as cols, dest as f:
+                n, m = distance_matrix(rows, cols, f, args.unit, args.dtype, args.tile, args.jobs, args.engine)
+            report_throughput(f"{n} x {m} distances:", n * m, 0, started)
+        else:
+            origin, path = (args.target, args.source) if is_file[0] else (args.source, args.target)
+            with open_input(path) as f:
+                count = distance_one_to_many(parse_point(origin), f, out, args.unit, args.engine)
+            report_throughput("Distances", count, 0, started)
+    
+    elif args.cmd == "beam" and args.batch:
+        started = time.perf_counter()
+        with open_input(args.batch) as f:
+            count, errors = beam_batch(f, out, args.jobs)
+        report_throughput("Beams", count, errors, started)
+    
+    elif args.cmd == "beam" and args.mode == "sweep":
+        if args.circ is None:
+            parser.error("beam sweep requires --circ")
+        started = time.perf_counter()
+        grid = (args.circ, args.shoes, args.boot, args.rise)
+        count = (beam_sweep_summary if args.summary else beam_sweep)(grid, out)
+        report_throughput("Sweep points", count, 0, started)
     
     elif args.cmd == "beam":
-        b = BeamCalc(args.circ, args.shoes, args.boot, args.rise)
-        print(b.report())
+        if args.circ is None:
+            parser.error("beam requires --circ or --batch")
+        values = (args.circ, args.shoes, args.boot, args.rise)
+        if any(len(v) > 1 for v in values):
+            parser.error("ranges need 'beam sweep'")
+        b = beam_calc(args.circ[0], args.shoes[0], args.boot[0], args.rise[0])
+        if structured:
+            out.write(b.as_dict())
+        else:
+            print(b.report())
+    
+    elif args.cmd == "optimize-cuts":
+        with open_input(args.beams) as f:
+            bands, mesh, errors = cut_demand(f)
+        for row, error in errors.items():
+            print(f"Skipped row {row}: {error}", file=sys.stderr)
+        for material, pieces, stock in (("band", bands, args.band_stock), ("mesh", mesh, args.mesh_stock)):
+            plan = optimize_cuts(material, pieces, stock, args.time_budget)
+            if structured:
+                out.write(plan.as_dict())
+            else:
+                print(plan.report())
     
     elif args.cmd == "offset":
         r = rolling_offset(args.angle, args.offset)
-        print(f"Travel:  {r['travel']:.4f}\"\nAdvance: {r['advance']:.4f}\"")
+        if structured:
+            out.write(r)
+        else:
+            print(f"Travel:  {r['travel']:.4f}\"\nAdvance: {r['advance']:.4f}\"")
     
     elif args.cmd == "cutback":
         r = cutback(args.angle, args.offset)
-        print(f"Cut: {r['cut']:.4f}\"")
+        if structured:
+            out.write(r)
+        else:
+            print(f"Cut: {r['cut']:.4f}\"")
     
     elif args.cmd == "calibrate":
+        select_grid(args)
+        if args.from_point and args.to_point:
+            args.satellite = geodesic(*parse_point(args.from_point), *parse_point(args.to_point),
+                                      args.unit, args.engine)
+        elif args.satellite is None:
+            parser.error("calibrate requires --satellite or --from/--to")
         r = calibrate(args.satellite, args.field)
-        status = "✓ CALIBRATED" if r["calibrated"] else "✗ ADJUST"
-        print(f"Diff: {r['difference']:+.2f} {args.unit} ({r['pct_error']:+.2f}%)\n{status}")
+        if structured:
+            out.write({**r, "unit": args.unit})
+        else:
+            status = "✓ CALIBRATED" if r["calibrated"] else "✗ ADJUST"
+            print(f"Diff: {r['difference']:+.2f} {args.unit} ({r['pct_error']:+.2f}%)\n{status}")
+    
+    elif (args.cmd == "jobs" and args.action in JOB_READERS or args.cmd == "export" and not args.sources) \
+            and not os.path.exists(os.path.join(args.store, "journal.bin")):
+        if args.cmd == "jobs" and args.action == "show":
+            parser.error(f"no jobs in {args.store}")
+        print(f"No jobs in {args.store}", file=sys.stderr)
+    
+    elif args.cmd == "jobs" and args.action == "import":
+        with JobJournal(args.store) as journal:
+            paths = args.files or sorted(glob.glob(os.path.join(args.store, "job_*.json")))
+            count = journal.import_legacy(paths)
+        if structured:
+            out.write({"imported": count, "journal": journal.path})
+        else:
+            print(f"Imported {count} jobs -> {journal.path}")
+    
+    elif args.cmd == "jobs" and args.action == "query":
+        filters = [f"timestamp>={args.since}"] * bool(args.since) + [f"timestamp<={args.until}"] * bool(args.until)
+        ranges = {}
+        try:
+            for name, lo, hi in map(parse_filter, args.filters + filters):
+                old = ranges.get(name, (-math.inf, math.inf))
+                ranges[name] = (max(lo, old[0]), min(hi, old[1]))
+        except ValueError as e:
+            parser.error(str(e))
+        started = time.perf_counter()
+        with JobJournal(args.store, readonly=True) as journal:
+            index = JobIndex(journal)
+            index.refresh()
+            ids = index.query(ranges, args.location, args.order, args.desc, args.limit)
+            out.set_fields(("id",) if args.ids else JOB_FIELDS)
+            for job in ({"id": i} for i in ids) if args.ids else journal.get_many(ids):
+                out.write(job)
+        report_throughput("Matched", len(ids), 0, started)
+    
+    elif args.cmd == "jobs" and args.action == "near":
+        if POINT_SPEC.match(args.point) or SEPARATOR in args.point:
+            lat, lon = parse_point(args.point)
+        else:
+            found = find_locality(args.point) or parser.error(f"unknown locality {args.point!r}")
+            lat, lon = found[1]
+        started = time.perf_counter()
+        scale = UNIT_CONV[args.unit]
+        with JobJournal(args.store, readonly=True) as journal:
+            index = JobIndex(journal)
+            index.refresh()
+            hits = index.near(lat, lon, args.radius / scale)[:args.limit]
+            out.set_fields((*JOB_FIELDS, "distance", "unit"))
+            for job, (_, d) in zip(journal.get_many([i for i, _ in hits]), hits):
+                out.write({**job, "distance": d * scale, "unit": args.unit})
+        report_throughput("Nearby", len(hits), 0, started)
+    
+    elif args.cmd == "jobs" and args.action == "diagnostics":
+        with JobJournal(args.store, readonly=True) as journal:
+            report = save_diagnostics(journal)
+        if structured:
+            out.write(report)
+        else:
+            for key, value in report.items():
+                print(f"{key + ':':<20} {value:.3f}" if isinstance(value, float) else f"{key + ':':<20} {value}")
+    
+    elif args.cmd == "jobs" and args.action == "sync":
+        with JobJournal(args.store) as journal:
+            syncing = sync_jobs(journal, args.url, args.batch, args.retries, args.timeout)
+            report = next(syncing)
+            try:
+                for report in syncing:
+                    pass
+            except OSError as e:
+                sys.exit(f"Sync interrupted at job {report['cursor']} of {report['total']}: {e}; "
+                         f"run again to resume")
+        if structured:
+            out.write(report)
+        else:
+            print(f"Synced {report['sent']} jobs to {args.url} ({report['stored']} new, "
+                  f"{report['skipped']} already there) in {report['batches']} batches, "
+                  f"{report['bytes'] / 1024:.1f} KiB before gzip")
+    
+    elif args.cmd == "jobs" and args.action == "reconcile":
+        started = time.perf_counter()
+        with contextlib.ExitStack() as stack:
+            ours = JobCollector(stack.enter_context(JobJournal(args.store)))
+            if re.match(r"https?://", args.peer):
+                theirs = RemoteCollector(args.peer, args.retries, args.timeout)
+            elif os.path.isdir(args.peer):
+                theirs = JobCollector(stack.enter_context(JobJournal(args.peer)))
+            else:
+                parser.error(f"no store or URL {args.peer!r}")
+            report = {"peer": args.peer, **reconcile(ours, theirs, args.dry_run),
+                      "requests": getattr(theirs, "requests", None), "bytes": getattr(theirs, "bytes", None),
+                      "seconds": time.perf_counter() - started}
+        if structured:
+            out.write(report)
+        else:
+            pulled, pushed = ("would pull", "would push") if args.dry_run else ("pulled", "pushed")
+            print(f"{report['differing_buckets']} differing hour buckets in {report['rounds']} rounds: "
+                  f"{pulled} {report['pulled']}, {pushed} {report['pushed']}")
+    
+    elif args.cmd == "jobs" and args.action == "totals":
+        out.set_fields((args.by, *TOTALS_FIELDS))
+        
+        def show(rows: List[dict]):
+            for rec in rows:
+                if structured:
+                    out.write(rec)
+                else:
+                    print(f"{rec[args.by][:28]:<28} {rec['jobs']:>6} jobs  {rec['band_ft']:>10.1f} band ft  "
+                          f"{rec['mesh_sqft']:>10.1f} mesh sq ft  {rec['beam_ft']:>9.1f} beam ft")
+            sys.stdout.flush()
+        
+        with JobJournal(args.store, readonly=True) as journal:
+            totals = JobTotals(journal)
+            totals.update()
+            show(totals.rows(args.by))
+            if args.watch:
+                watcher = StoreWatcher(journal.index_path, args.interval)
+                print(f"Watching {journal.index_path} ({watcher.mode}); Ctrl-C to stop", file=sys.stderr)
+                try:
+                    while True:
+                        watcher.wait()
+                        changed = totals.update()
+                        if changed:
+                            if not structured:
+                                print(f"-- {datetime.now():%H:%M:%S}, {totals.cursor} jobs")
+                            show(totals.rows(args.by, {key for group, key in changed if group == args.by}))
+                except KeyboardInterrupt:
+                    pass
+                finally:
+                    watcher.close()
+    
+    elif args.cmd == "jobs" and args.action == "show":
+        with JobJournal(args.store, readonly=True) as journal:
+            job = journal[args.id]
+        out.set_fields(JOB_FIELDS)
+        if structured:
+            out.write(job)
+        else:
+            print(json.dumps(job, indent=2))
+    
+    elif args.cmd == "jobs":
+        with JobJournal(args.store, readonly=True) as journal:
+            total = len(journal)
+            stop = total - args.page * args.per_page
+            jobs = journal.page(max(stop - args.per_page, 0), min(args.per_page, max(stop, 0)))[::-1]
+        out.set_fields(JOB_FIELDS)
+        for job in jobs:
+            if structured:
+                out.write(job)
+            else:
+                print(job_summary(job))
+        if not structured:
+            pages = max(math.ceil(total / args.per_page), 1)
+            print(f"page {args.page + 1} of {pages} ({total} jobs)")
+    
+    elif args.cmd == "export":
+        started = time.perf_counter()
+        with contextlib.ExitStack() as stack:
+            if args.sources:
+                records, source = iter_records(args.sources), " ".join(args.sources)
+            else:
+                records, source = stack.enter_context(JobJournal(args.store, readonly=True)).scan(), args.store
+                out.set_fields(JOB_FIELDS)
+            if not args.columnar:
+                for rec in records:
+                    out.write(rec)
+                report_throughput("Exported", out.count, 0, started)
+                return
+            path = args.output or ("recon.ptcc" if args.sources else "jobs.ptcc")
+            footer = write_columns(path, records, source)
+        out.set_fields(("column", "type", "encoding", "count", "nulls", "min", "max", "mean", "distinct"))
+        for c in footer["columns"]:
+            rec = {"column": c["name"], "type": c["type"], "encoding": c.get("encoding", "plain"), **c["stats"]}
+            if structured:
+                out.write(rec)
+            else:
+                lo, hi = (f"{v:.6g}" if isinstance(v, float) else str(v) for v in (rec.get("min"), rec.get("max")))
+                print(f"{c['name']:<28} {c['type']:<8} {rec['count']:>8} rows  {rec['nulls']:>6} null  "
+                      f"{lo[:26]:>26} .. {hi[:26]}")
+        print(f"Wrote {footer['rows']} rows x {len(footer['columns'])} columns to {path} "
+              f"({os.path.getsize(path) / 1024:.0f} KiB) in {time.perf_counter() - started:.2f}s", file=sys.stderr)
     
     elif args.cmd == "hyp":
         t = pythagorean(args.run, args.rise)
-        print(f"Travel: {t:.4f}\" ({t/12:.4f} ft)")
+        if structured:
+            out.write({"run": args.run, "rise": args.rise, "travel": t})
+        else:
+            print(f"Travel: {t:.4f}\" ({t/12:.4f} ft)")
     
     else:
         parser.print_help()
 
 
+# ============================================================
+# DAEMON
+# ============================================================
+
+# One JSON request per line, {"argv": [...]}, answered by one JSON line
+# {"status": int, "stdout": str, "stderr": str}. The ptc launcher speaks the
+# same protocol without importing this module.
+
+DAEMON_SOCKET = os.environ.get("PTC_SOCKET") or os.path.join(
+    os.environ.get("TMPDIR", "/tmp"), f"ptc-{os.getuid()}.sock")
+
+_daemon_lock = threading.Lock()
+
+
+def daemon_run(argv: Sequence[str]) -> dict:
+    """Run one command line in-process, capturing what it would have printed."""
+    refusal = in_process_refusal(argv)
+    if refusal:
+        return {"status": 2, "stdout": "", "stderr": f"{' '.join(argv)!r} cannot run in the daemon: {refusal}\n"}
+    stdout, stderr = io.StringIO(), io.StringIO()
+    with _daemon_lock, isolated_state(), contextlib.redirect_stdout(stdout), contextlib.redirect_stderr(stderr):
+        status = 0
+        try:
+            main(argv)
+        except SystemExit as e:
+            if isinstance(e.code, str):
+                print(e.code, file=sys.stderr)
+            status = e.code if isinstance(e.code, int) else int(e.code is not None)
+        except Exception as e:
+            print(f"error: {e}", file=sys.stderr)
+            status = 1
+    return {"status": status, "stdout": stdout.getvalue(), "stderr": stderr.getvalue()}
+
+
+class _DaemonHandler(socketserver.StreamRequestHandler):
+    def handle(self):
+        for line in self.rfile:
+            try:
+                argv = json.loads(line)["argv"]
+            except (ValueError, KeyError, TypeError):
+                reply = {"status": 2, "stdout": "", "stderr": "bad request\n"}
+            else:
+                reply = daemon_run([str(a) for a in argv])
+            self.wfile.write(json.dumps(reply).encode() + b"\n")
+            self.wfile.flush()
+
+
+class DaemonClient:
+    """Keeps one connection open for many calls (what the bench measures)."""
+    
+    def __init__(self, path: str = DAEMON_SOCKET):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.file = self.sock.makefile("rwb")
+    
+    def call(self, argv: Sequence[str]) -> dict:
+        self.file.write(json.dumps({"argv": list(argv)}).encode() + b"\n")
+        self.file.flush()
+        return json.loads(self.file.readline())
+    
+    def close(self):
+        self.file.close()
+        self.sock.close()
+
+
+def serve(path: str):
+    """Answer requests on a Unix socket until SIGTERM/SIGINT.
+
+    Commands run one at a time (they share stdout redirection and the
+    gazetteer/grid globals); connections are threaded so an idle client
+    cannot block the others.
+    """
+    if os.path.exists(path):
+        try:
+            DaemonClient(path).close()
+            sys.exit(f"a daemon is already listening on {path}")
+        except OSError:
+            os.unlink(path)
+    
+    warm_state()
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    server = socketserver.ThreadingUnixStreamServer(path, _DaemonHandler)
+    server.daemon_threads = True
+    print(f"Serving on {path}", file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+        os.unlink(path)
+
+
+# ============================================================
+# HTTP SERVICE
+# ============================================================
+
+# GET with query parameters or POST a JSON object; every endpoint answers
+# one JSON object. Errors are 400 {"error": ...}. /metrics reports the
+# result-cache counters of whichever worker answered.
+
+def _http_calibrate(q: dict) -> dict:
+    unit = q.get("unit", "ft")
+    if "from" in q and "to" in q:
+        satellite = geodesic(*parse_point(q["from"]), *parse_point(q["to"]), unit, q.get("engine", "haversine"))
+    else:
+        satellite = float(q["satellite"])
+    return {**calibrate(satellite, float(q["field"])), "unit": unit}
+
+
+def _http_distance(q: dict) -> dict:
+    unit, engine = q.get("unit", "ft"), q.get("engine", "haversine")
+    d = geodesic(*parse_point(q["from"]), *parse_point(q["to"]), unit, engine)
+    return {"from": q["from"], "to": q["to"], "distance": d, "unit": unit, "engine": engine}
+
+
+HTTP_ENDPOINTS = {
+    "beam": lambda q: _beam_row(q).as_dict(),
+    "offset": lambda q: rolling_offset(float(q["angle"]), float(q["offset"])),
+    "cutback": lambda q: cutback(float(q["angle"]), float(q["offset"])),
+    "calibrate": _http_calibrate,
+    "decode": lambda q: {"code": q["code"], **decode_plus_code(q["code"]).as_dict()},
+    "distance": _http_distance,
+}
+
+
+class _HttpHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # keep-alive; every reply carries Content-Length
+    server_version = "ptc"
+    disable_nagle_algorithm = True  # headers and body go out as separate writes
+    
+    def do_GET(self):
+        self._dispatch(b"")
+    
+    def do_POST(self):
+        self._dispatch(self.rfile.read(int(self.headers.get("Content-Length") or 0)))
+    
+    def _dispatch(self, body: bytes):
+        url = urllib.parse.urlsplit(self.path)
+        name = url.path.strip("/")
+        if name == "healthz":
+            status, result = 200, {"status": "ok", "pid": os.getpid()}
+        elif name == "readyz":  # the worker binds first and warms up behind it
+            ready = _http_warm.is_set()
+            status, result = (200 if ready else 503), {"status": "ok" if ready else "warming", "pid": os.getpid()}
+        elif name == "metrics":
+            status, result = 200, {"pid": os.getpid(), "cache": cache_stats()}
+        elif name in HTTP_ENDPOINTS:
+            try:
+                params = dict(urllib.parse.parse_qsl(url.query))
+                if body:
+                    params.update(json.loads(body))
+                status, result = 200, HTTP_ENDPOINTS[name](params)
+            except KeyError as e:
+                status, result = 400, {"error": f"missing or unknown {e}"}
+            except (TypeError, ValueError, IndexError, AttributeError, ArithmeticError) as e:
+                status, result = 400, {"error": str(e) or type(e).__name__}
+        else:
+            status, result = 404, {"error": f"no endpoint /{name}", "endpoints": sorted(HTTP_ENDPOINTS)}
+        self._reply(status, result)
+    
+    def _reply(self, status: int, result: dict):
+        try:
+            data = json.dumps(result, allow_nan=False).encode()
+        except ValueError:  # inf/nan inputs; bare Infinity and NaN are not JSON
+            status, data = 400, b'{"error": "non-finite number in result"}'
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+    
+    def log_message(self, format, *args):
+        pass
+
+
+class _HttpServer(ThreadingHTTPServer):
+    allow_reuse_port = True  # every worker binds the port; the kernel spreads connections
+    daemon_threads = True
+
+
+_http_warm = threading.Event()
+
+
+def _http_worker(host: str, port: int):
+    server = _HttpServer((host, port), _HttpHandler)
+    threading.Thread(target=lambda: (warm_state(), _http_warm.set()), name="warm", daemon=True).start()
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+
+
+def serve_http(host: str, port: int, workers: int = 0):
+    """One process per core, each a threaded keep-alive server on the same port."""
+    workers = workers or os.cpu_count() or 1
+    print(f"Serving HTTP on {host}:{port} with {workers} worker(s)", file=sys.stderr)
+    if workers == 1:
+        return _http_worker(host, port)
+    procs = [multiprocessing.Process(target=_http_worker, args=(host, port), daemon=True)
+             for _ in range(workers)]
+    for proc in procs:
+        proc.start()
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    try:
+        for proc in procs:
+            proc.join()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for proc in procs:
+            proc.terminate()
+            proc.join()
+
+
+# ============================================================
+# JOB SYNC
+# ============================================================
+
+# `jobs sync` pushes a journal to a collector (`jobs collect`) in batches
+# of two gzipped POSTs: /sync/have with the batch's content digests, which
+# answers the ones the collector lacks, then /sync/jobs with only those
+# jobs as pack_jobs() records. The digest leaves out the local id, so a job re-sent
+# after a lost reply, or from a second device, is stored once. The cursor
+# per collector URL advances after every acknowledged batch.
+
+SYNC_BATCH = 500
+
+
+def job_digest(job: dict) -> str:
+    """Content hash of a job, independent of its id in any one store."""
+    body = {k: v for k, v in job.items() if k != "id"}
+    return hashlib.sha256(json.dumps(body, sort_keys=True, separators=(",", ":")).encode()).hexdigest()
+
+
+def _sync_post(url: str, path: str, data: bytes, timeout: float, retries: int) -> dict:
+    request = urllib.request.Request(url.rstrip("/") + path, gzip.compress(data),
+                                     {"Content-Type": "application/json", "Content-Encoding": "gzip"})
+    for attempt in range(retries + 1):
+        try:
+            with urllib.request.urlopen(request, timeout=timeout) as resp:
+                return json.loads(resp.read())
+        except urllib.error.HTTPError as e:
+            if e.code < 500 or attempt == retries:
+                raise
+        except OSError:
+            if attempt == retries:
+                raise
+        time.sleep(min(2 ** attempt, 30))
+
+
+def sync_jobs(journal: JobJournal, url: str, batch: int = SYNC_BATCH, retries: int = 3,
+              timeout: float = 30.0) -> Iterator[dict]:
+    """Push jobs saved since the last sync to `url`, yielding the running totals after each batch.
+    
+    A connection that stays down past `retries` raises OSError; the cursor
+    then holds the last acknowledged batch and the next call resumes there.
+    """
+    if batch < 1:  # an empty page never moves the cursor
+        raise ValueError(f"sync batch must be at least 1, got {batch}")
+    cursor_path = os.path.join(journal.root, "sync_cursor.json")
+    try:
+        with open(cursor_path) as f:
+            cursors = json.load(f)
+    except (OSError, ValueError):
+        cursors = {}
+    report = {"collector": url, "cursor": cursors.get(url, 0), "total": len(journal),
+              "sent": 0, "stored": 0, "skipped": 0, "batches": 0, "bytes": 0}
+    yield report
+    while report["cursor"] < report["total"]:
+        jobs = journal.page(report["cursor"], min(batch, report["total"] - report["cursor"]))
+        digests = [job_digest(job) for job in jobs]
+        data = json.dumps(digests).encode()
+        missing = set(_sync_post(url, "/sync/have", data, timeout, retries)["missing"])
+        send = [job for job, d in zip(jobs, digests) if d in missing]
+        if send:
+            frames = pack_jobs(send)
+            report["stored"] += _sync_post(url, "/sync/jobs", frames, timeout, retries)["stored"]
+            data += frames
+        report["cursor"] += len(jobs)
+        report["sent"] += len(send)
+        report["skipped"] += len(jobs) - len(send)
+        report["batches"] += 1
+        report["bytes"] += len(data)
+        cursors[url] = report["cursor"]
+        with open(cursor_path + ".tmp", "w") as f:
+            json.dump(cursors, f)
+        os.replace(cursor_path + ".tmp", cursor_path)
+        yield report
+
+
+class JobTree:
+    """Merkle tree over content digests, bucketed by the job's timestamp.
+    
+    Levels are year, month, day and hour prefixes of the ISO timestamp under
+    a root of "". An hour bucket hashes its sorted digests; every other node
+    hashes its children's (prefix, hash) pairs. Two stores that agree on a
+    node agree on every job under it, so comparing from the root down only
+    visits the buckets that differ. Hashes are cached and dropped along the
+    path of each added job.
+    """
+    
+    LEVELS = (4, 7, 10, 13)
+    
+    def __init__(self):
+        self.buckets = collections.defaultdict(set)
+        self.children = collections.defaultdict(set)
+        self._hashes = {}
+    
+    @classmethod
+    def path(cls, job: dict) -> List[str]:
+        stamp = str(job.get("timestamp") or "")[:cls.LEVELS[-1]].ljust(cls.LEVELS[-1], "?")
+        return ["", *(stamp[:n] for n in cls.LEVELS)]
+    
+    def add(self, job: dict, digest: str):
+        path = self.path(job)
+        self.buckets[path[-1]].add(digest)
+        for parent, child in zip(path, path[1:]):
+            self.children[parent].add(child)
+        for prefix in path:
+            self._hashes.pop(prefix, None)
+    
+    def hash(self, prefix: str = "") -> str:
+        h = self._hashes.get(prefix)
+        if h is None:
+            if len(prefix) == self.LEVELS[-1]:
+                body = "".join(sorted(self.buckets.get(prefix, ())))
+            else:
+                body = "".join(c + self.hash(c) for c in sorted(self.children.get(prefix, ())))
+            h = self._hashes[prefix] = hashlib.sha256(body.encode()).hexdigest()[:32]  # 128 bits is plenty
+        return h
+    
+    def nodes(self, prefix: str) -> dict:
+        """{child prefix: hash} below `prefix`."""
+        return {c: self.hash(c) for c in self.children.get(prefix, ())}
+
+
+class JobCollector:
+    """A journal plus the digests in it: the receiving end of `jobs sync` and one side of a reconcile."""
+    
+    def __init__(self, journal: JobJournal):
+        self.journal = journal
+        self.digests = {}
+        self.tree = JobTree()
+        for job in journal.scan():
+            d = job_digest(job)
+            self.digests.setdefault(d, job["id"])
+            self.tree.add(job, d)
+        self._lock = threading.Lock()
+    
+    def missing(self, digests: List[str]) -> List[str]:
+        return [d for d in digests if d not in self.digests]
+    
+    def accept(self, jobs: List[dict]) -> Tuple[int, int]:
+        """Store the jobs not seen before; returns (stored, duplicates)."""
+        with self._lock:
+            fresh = {}
+            for job in jobs:
+                job.pop("id", None)
+                d = job_digest(job)
+                if d not in self.digests:
+                    fresh.setdefault(d, job)
+            for (d, job), i in zip(fresh.items(), self.journal.append_many(list(fresh.values()))):
+                self.digests[d] = i
+                self.tree.add(job, d)
+        return len(fresh), len(jobs) - len(fresh)
+    
+    def nodes(self, prefixes: List[str]) -> dict:
+        with self._lock:
+            return {p: self.tree.nodes(p) for p in prefixes}
+    
+    def buckets(self, prefixes: List[str]) -> dict:
+        with self._lock:
+            return {p: sorted(self.tree.buckets.get(p, ())) for p in prefixes}
+    
+    def fetch(self, digests: List[str]) -> List[dict]:
+        return list(self.journal.get_many([self.digests[d] for d in digests]))
+
+
+class RemoteCollector:
+    """JobCollector's reconcile calls, made against a `jobs collect` URL."""
+    
+    def __init__(self, url: str, retries: int = 3, timeout: float = 30.0):
+        self.url, self.retries, self.timeout = url, retries, timeout
+        self.requests = self.bytes = 0
+    
+    def _call(self, path: str, data: bytes) -> dict:
+        reply = _sync_post(self.url, path, data, self.timeout, self.retries)
+        self.requests += 1
+        self.bytes += len(data) + len(json.dumps(reply))  # JSON both ways, before gzip
+        return reply
+    
+    def nodes(self, prefixes: List[str]) -> dict:
+        return self._call("/merkle/nodes", json.dumps(prefixes).encode())
+    
+    def buckets(self, prefixes: List[str]) -> dict:
+        return self._call("/merkle/buckets", json.dumps(prefixes).encode())
+    
+    def fetch(self, digests: List[str]) -> List[dict]:
+        return self._call("/sync/fetch", json.dumps(digests).encode())["jobs"]
+    
+    def accept(self, jobs: List[dict]) -> Tuple[int, int]:
+        r = self._call("/sync/jobs", pack_jobs(jobs))
+        return r["stored"], r["duplicates"]
+
+
+def reconcile(ours, theirs, dry_run: bool = False, batch: int = SYNC_BATCH) -> dict:
+    """Make two collectors hold the same jobs, transferring only the ones that differ.
+    
+    Walks both Merkle trees one level per round, asking each side only for
+    the nodes whose hashes disagreed in the round before, so the exchange
+    grows with the number of differing buckets times the tree depth, not
+    with the size of either store.
+    """
+    report = {"rounds": 0, "differing_buckets": 0, "pulled": 0, "pushed": 0}
+    frontier = [""]
+    for _ in JobTree.LEVELS:
+        a, b = ours.nodes(frontier), theirs.nodes(frontier)
+        report["rounds"] += 1
+        frontier = [c for p in frontier for c in sorted(a[p].keys() | b[p].keys()) if a[p].get(c) != b[p].get(c)]
+        if not frontier:
+            break
+    report["differing_buckets"] = len(frontier)
+    pull, push = [], []
+    if frontier:
+        a, b = ours.buckets(frontier), theirs.buckets(frontier)
+        report["rounds"] += 1
+        for p in frontier:
+            mine, other = set(a[p]), set(b[p])
+            pull += sorted(other - mine)
+            push += sorted(mine - other)
+    report["pulled"], report["pushed"] = len(pull), len(push)
+    if not dry_run:
+        for src, dst, digests in ((theirs, ours, pull), (ours, theirs, push)):
+            for i in range(0, len(digests), batch):
+                dst.accept(src.fetch(digests[i:i + batch]))
+    return report
+
+
+class _CollectorHandler(_HttpHandler):
+    collector: JobCollector = None
+    
+    def _dispatch(self, body: bytes):
+        name = urllib.parse.urlsplit(self.path).path.strip("/")
+        try:
+            if self.headers.get("Content-Encoding") == "gzip":
+                body = gzip.decompress(body)
+            if name in ("healthz", "readyz"):
+                status, result = 200, {"status": "ok", "jobs": len(self.collector.journal)}
+            elif name == "sync/have":
+                status, result = 200, {"missing": self.collector.missing(json.loads(body))}
+            elif name == "sync/jobs":
+                stored, duplicates = self.collector.accept(unpack_jobs(body))
+                status, result = 200, {"stored": stored, "duplicates": duplicates}
+            elif name == "sync/fetch":
+                status, result = 200, {"jobs": self.collector.fetch(json.loads(body))}
+            elif name == "merkle/nodes":
+                status, result = 200, self.collector.nodes(json.loads(body))
+            elif name == "merkle/buckets":
+                status, result = 200, self.collector.buckets(json.loads(body))
+            else:
+                status, result = 404, {"error": f"no endpoint /{name}"}
+        except KeyError as e:
+            status, result = 404, {"error": f"unknown digest {e}"}
+        except (OSError, EOFError, TypeError, ValueError, AttributeError, struct.error) as e:
+            status, result = 400, {"error": str(e) or type(e).__name__}
+        self._reply(status, result)
+
+
+def serve_collector(store: str, host: str, port: int):
+    """One process, so the digest set stays the single source of truth."""
+    with JobJournal(store) as journal:
+        handler = type("CollectorHandler", (_CollectorHandler,), {"collector": JobCollector(journal)})
+        server = ThreadingHTTPServer((host, port), handler)
+        server.daemon_threads = True
+        print(f"Collecting jobs into {store} on {host}:{port}", file=sys.stderr)
+        signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+        try:
+            server.serve_forever()
+        except KeyboardInterrupt:
+            pass
+        finally:
+            server.server_close()
+
+
 if __name__ == "__main__":
     main()
@@ -0,0 +1,739 @@
+#!/usr/bin/env python3
+"""
+PIPE TRADES CLI - Benchmarks
+============================
+Scalar vs batch throughput for the bulk paths in main.py
+
+Usage:
+    python scripts/bench.py decode --n 200000
+    python scripts/bench.py encode --n 200000 --length 11
+    python scripts/bench.py gazetteer --localities 5000 --n 20000
+    python scripts/bench.py distance --n 1000 --jobs 4
+    python scripts/bench.py geodesic --n 100000
+    python scripts/bench.py beam --n 200000
+    python scripts/bench.py daemon --n 2000 --cold 20
+    python scripts/bench.py cache --n 200000 --distinct 500
+    python scripts/bench.py journal --n 20000 --threads 8
+    python scripts/bench.py query --n 100000
+    python scripts/bench.py sync --n 20000 --batch 500
+    python scripts/bench.py reconcile --n 100000 --diff 50
+    python scripts/bench.py codec --n 50000
+    python scripts/bench.py columnar --n 50000
+    python scripts/bench.py totals --n 100000 --new 50
+"""
+
+import argparse
+import json
+import math
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent))
+
+import main  # noqa: E402
+
+
+def timed(fn, *args):
+    started = time.perf_counter()
+    result = fn(*args)
+    return result, time.perf_counter() - started
+
+
+def row(label: str, n: int, elapsed: float, base: float = None):
+    speedup = f"  x{base / elapsed:.1f}" if base else ""
+    print(f"  {label:<22} {elapsed:8.3f}s  {n / elapsed:>12,.0f}/s{speedup}")
+
+
+def random_codes(n: int, rng: random.Random):
+    a = main.CODE_ALPHABET
+    return [
+        a[rng.randrange(9)] + a[rng.randrange(18)]
+        + "".join(rng.choice(a) for _ in range(6)) + "+"
+        + "".join(rng.choice(a) for _ in range(2))
+        for _ in range(n)
+    ]
+
+
+# ============================================================
+# SUITES
+# ============================================================
+
+def bench_decode(args):
+    codes = random_codes(args.n, random.Random(args.seed))
+    print(f"decode: {args.n} full codes")
+
+    scalar, t_scalar = timed(lambda: [main.decode_plus_code(c) for c in codes])
+    batch, t_batch = timed(main.decode_plus_codes, codes)
+    row("decode_plus_code", args.n, t_scalar)
+    row("decode_plus_codes", args.n, t_batch, t_scalar)
+
+    mismatches = sum(batch[i] != a for i, a in enumerate(scalar))
+
+    # malformed: a '0' put in or over a digit must fail both paths, not decode elsewhere
+    rng = random.Random(args.seed)
+    bad = [c[:k] + "0" + c[k + (k % 2):] for c in codes[:1000] for k in [rng.choice((1, 2, 3, 5, 6, 9))]]
+    bad_batch = main.decode_plus_codes(bad)
+    for i, code in enumerate(bad):
+        try:
+            expected = main.decode_plus_code(code)
+        except (ValueError, IndexError):
+            expected = None
+        mismatches += bad_batch[i] != expected if expected else bad_batch.valid(i)
+    print(f"  mismatches: {mismatches} (incl. {len(bad)} malformed)")
+    return mismatches == 0
+
+
+def bench_encode(args):
+    rng = random.Random(args.seed)
+    lats = [rng.uniform(-90, 90) for _ in range(args.n)]
+    lons = [rng.uniform(-180, 180) for _ in range(args.n)]
+    print(f"encode: {args.n} points, {args.length} digits")
+
+    scalar, t_scalar = timed(lambda: [main.encode_plus_code(la, lo, args.length) for la, lo in zip(lats, lons)])
+    batch, t_batch = timed(main.encode_plus_codes, lats, lons, args.length)
+    row("encode_plus_code", args.n, t_scalar)
+    row("encode_plus_codes", args.n, t_batch, t_scalar)
+
+    mismatches = sum(a != b for a, b in zip(scalar, batch))
+    print(f"  mismatches: {mismatches}")
+    return mismatches == 0
+
+
+def bench_gazetteer(args):
+    rng = random.Random(args.seed)
+    names = list(dict.fromkeys(f"unit {rng.randrange(10**6)} gate {i}" for i in range(args.localities)))
+    points = {name: (30 + rng.random(), -93 - rng.random()) for name in names}
+    texts = [f"5MHH+P8 {rng.choice(names)}" if rng.random() < 0.8 else "5MHH+P8 nowhere"
+             for _ in range(args.n)]
+    gaz = main.Gazetteer.from_points(points)
+    print(f"gazetteer: {len(gaz)} localities, {args.n} lookups")
+
+    def scan():
+        return [next((k for k in points if k in t.lower()), None) for t in texts]
+
+    def automaton():
+        return [gaz.name(i) if i >= 0 else None for i in map(gaz.match, texts)]
+
+    expected, t_scan = timed(scan)
+    found, t_match = timed(automaton)
+    row("substring scan", args.n, t_scan)
+    row("Gazetteer.match", args.n, t_match, t_scan)
+
+    mismatches = sum(a != b for a, b in zip(expected, found))
+    print(f"  mismatches: {mismatches}")
+    return mismatches == 0
+
+
+def bench_distance(args):
+    import io
+    from array import array
+
+    rng = random.Random(args.seed)
+    pts = [(30.15 + rng.random() * 0.1, -93.4 + rng.random() * 0.2) for _ in range(args.n)]
+    cols = main.PointSet(array("d", (p[0] for p in pts)), array("d", (p[1] for p in pts)))
+    csv_pts = "lat,lon\n" + "".join(f"{la},{lo}\n" for la, lo in pts)
+    n = args.n * args.n
+    print(f"distance: {args.n} x {args.n} matrix")
+
+    scalar, t_scalar = timed(lambda: [main.haversine(a, b, c, d) for a, b in pts for c, d in pts])
+    many, t_many = timed(lambda: [x for a, b in pts for x in main.haversine_many(a, b, cols)])
+    _, t_matrix = timed(lambda: main.distance_matrix(
+        io.StringIO(csv_pts), io.StringIO(csv_pts), io.BytesIO(), "ft", "f8", jobs=args.jobs))
+    row("haversine", n, t_scalar)
+    row("haversine_many", n, t_many, t_scalar)
+    row(f"distance_matrix x{args.jobs or 'all'}", n, t_matrix, t_scalar)
+
+    worst = max(abs(a - b) for a, b in zip(scalar, many))
+    print(f"  max difference: {worst:.2e} ft")
+    return worst < 1e-6
+
+
+def bench_geodesic(args):
+    from array import array
+
+    # Flinders Peak -> Buninyong, Vincenty (1975): 54972.271 m
+    flinders = main.vincenty(-37.95103342, 144.42486789, -37.65282114, 143.92649554, "m")
+    print(f"geodesic: Vincenty check {flinders:.3f} m (expected 54972.271)")
+    ok = abs(flinders - 54972.271) < 0.01
+
+    rng = random.Random(args.seed)
+    for label, spread in (("plant (<10 km)", 0.05), ("regional (<500 km)", 2.5)):
+        origin = (30.2266, -93.2174)
+        lats = array("d", (origin[0] + rng.uniform(-spread, spread) for _ in range(args.n)))
+        lons = array("d", (origin[1] + rng.uniform(-spread, spread) for _ in range(args.n)))
+        print(f"  {label}: {args.n} points from a fixed origin")
+
+        exact, t_v = timed(lambda: [main.vincenty(*origin, a, b) for a, b in zip(lats, lons)])
+        sphere, t_h = timed(lambda: [main.haversine(*origin, a, b) for a, b in zip(lats, lons)])
+        pts = main.PointSet(lats, lons)
+        v_many, t_vm = timed(main.vincenty_many, *origin, pts)
+        h_many, t_hm = timed(main.haversine_many, *origin, pts)
+        row("vincenty", args.n, t_v)
+        row("vincenty_many", args.n, t_vm, t_v)
+        row("haversine", args.n, t_h, t_v)
+        row("haversine_many", args.n, t_hm, t_v)
+        grid = main.LocalGrid.around(*origin, spread)
+        local, t_lm = timed(grid.distance_many, *origin, pts)
+        row("local grid", args.n, t_lm, t_v)
+
+        for name, dists in (("haversine", sphere), ("local grid", local)):
+            errors = [abs(d - v) / v * 100 for d, v in zip(dists, exact) if v]
+            print(f"  {name} vs WGS84: max {max(errors):.3f}%  mean {sum(errors) / len(errors):.3f}%")
+        print(f"  local grid documented bound: {grid.error_bound * 100:.3f}%")
+        ok &= max(abs(a - b) for a, b in zip(exact, v_many)) < 1e-6
+        ok &= all(abs(d - v) <= grid.error_bound * v + 1e-6 for d, v in zip(local, exact))
+    return ok
+
+
+def bench_beam(args):
+    rng = random.Random(args.seed)
+    cols = (
+        [rng.randint(30, 80) for _ in range(args.n)],
+        [rng.randint(0, 8) for _ in range(args.n)],
+        [rng.randint(0, 12) * 1.0 for _ in range(args.n)],
+        [rng.choice((0.0, 12.0, 30.0)) for _ in range(args.n)],
+    )
+    print(f"beam: {args.n} beams")
+
+    scalar, t_scalar = timed(lambda: [main.BeamCalc(*r).as_dict() for r in zip(*cols)])
+    batch, t_batch = timed(lambda: main.BeamBatch(*cols).rows())
+    row("BeamCalc.as_dict", args.n, t_scalar)
+    row("BeamBatch.rows", args.n, t_batch, t_scalar)
+
+    mismatches = sum(a != b for a, b in zip(scalar, batch))
+    print(f"  mismatches: {mismatches}")
+    return mismatches == 0
+
+
+def bench_daemon(args):
+    root = Path(__file__).resolve().parent.parent
+    cmd = ["beam", "--circ", "44", "--shoes", "4", "--boot", "6", "--rise", "30"]
+    sock = os.path.join(tempfile.mkdtemp(), "ptc.sock")
+    env = {**os.environ, "PTC_SOCKET": sock}
+    server = subprocess.Popen([sys.executable, str(root / "main.py"), "serve", "--socket", sock],
+                              stderr=subprocess.DEVNULL)
+    try:
+        while not os.path.exists(sock):
+            time.sleep(0.01)
+        print(f"daemon: {' '.join(cmd)}")
+        
+        def spawn(argv):
+            return [subprocess.run(argv, capture_output=True, text=True, env=env).stdout
+                    for _ in range(args.cold)]
+        
+        cold, t_cold = timed(spawn, [sys.executable, str(root / "main.py"), *cmd])
+        launcher, t_launcher = timed(spawn, [sys.executable, str(root / "ptc"), *cmd])
+        client = main.DaemonClient(sock)
+        warm, t_warm = timed(lambda: [client.call(cmd)["stdout"] for _ in range(args.n)])
+        client.close()
+    finally:
+        server.terminate()
+        server.wait()
+    
+    for label, n, elapsed in (("python main.py", args.cold, t_cold), ("ptc -> daemon", args.cold, t_launcher),
+                              ("DaemonClient.call", args.n, t_warm)):
+        print(f"  {label:<22} {elapsed / n * 1000:8.3f} ms/call")
+    mismatches = sum(out != cold[0] for out in cold + launcher + warm)
+    print(f"  mismatches: {mismatches}")
+    return mismatches == 0
+
+
+def bench_cache(args):
+    rng = random.Random(args.seed)
+    profiles = [(rng.randint(30, 80), rng.randint(0, 8), rng.randint(0, 12) * 1.0, rng.choice((0.0, 12.0, 30.0)))
+                for _ in range(args.distinct)]
+    codes = [f"{c[4:]} lake charles" for c in random_codes(args.distinct, rng)]
+    beams = [rng.choice(profiles) for _ in range(args.n)]
+    lookups = [rng.choice(codes) for _ in range(args.n)]
+    print(f"cache: {args.n} calls over {args.distinct} distinct inputs")
+    
+    for label, plain, cached, inputs in (
+        ("beam", lambda r: main.BeamCalc(*r).as_dict(), lambda r: main.beam_calc(*r).as_dict(), beams),
+        ("decode", main.decode_plus_code.__wrapped__, main.decode_plus_code, lookups),
+    ):
+        expected, t_plain = timed(lambda: [plain(x) for x in inputs])
+        found, t_cached = timed(lambda: [cached(x) for x in inputs])
+        row(f"{label} uncached", args.n, t_plain)
+        row(f"{label} cached", args.n, t_cached, t_plain)
+        if expected != found:
+            print(f"  {label}: cached results differ")
+            return False
+    for name, stats in main.cache_stats().items():
+        print(f"  {name:<8} hits {stats['hits']:>8}  misses {stats['misses']:>6}  "
+              f"evictions {stats['evictions']:>6}  {stats['bytes']:>9,} bytes")
+    return True
+
+
+def random_job(rng: random.Random, i: int) -> dict:
+    circ, shoes = rng.randint(30, 80), rng.randint(0, 8)
+    calc = main.BeamCalc(circ, shoes, rng.randint(0, 12) * 1.0, rng.choice((0.0, 12.0, 30.0)))
+    return {
+        "timestamp": f"2026-{1 + i % 12:02d}-{1 + i % 28:02d}T{i % 24:02d}:00:00",
+        "location": rng.choice(("5MHH+P8G Lake Charles", "6J8P+2F Sulphur", "")),
+        "lat": 30.2 + rng.uniform(-0.1, 0.1),
+        "lon": -93.3 + rng.uniform(-0.1, 0.1),
+        "inputs": {"circumference": circ, "shoes": shoes, "boot": calc.boot_final, "rise": calc.rise},
+        "outputs": {"beam_length": calc.beam_length, "band_qty": calc.band_qty,
+                    "mesh_panels": calc.mesh_qty, "total_mesh_sqft": calc.mesh_qty * calc.mesh_length * 40 / 144},
+    }
+
+
+def bench_journal(args):
+    import threading
+    
+    rng = random.Random(args.seed)
+    jobs = [random_job(rng, i) for i in range(args.n)]
+    root = Path(tempfile.mkdtemp())
+    print(f"journal: {args.n} jobs in {root}")
+    
+    def legacy_save():
+        for i, job in enumerate(jobs):
+            with open(root / "legacy" / f"job_{i:08d}.json", "w") as f:
+                json.dump(job, f, indent=2)
+                f.flush()
+                os.fsync(f.fileno())
+    
+    def journal_save():
+        per = -(-args.n // args.threads)
+        workers = [threading.Thread(target=lambda part: [journal.append(job) for job in part],
+                                    args=(jobs[i:i + per],)) for i in range(0, args.n, per)]
+        for w in workers:
+            w.start()
+        for w in workers:
+            w.join()
+    
+    (root / "legacy").mkdir()
+    journal = main.JobJournal(str(root / "store"))
+    _, t_legacy = timed(legacy_save)
+    _, t_journal = timed(journal_save)
+    row("file per job + fsync", args.n, t_legacy)
+    row(f"journal x{args.threads} threads", args.n, t_journal, t_legacy)
+    
+    queued = main.JobJournal(str(root / "queued"))
+    writer = main.JobWriter(queued)
+    futures, t_submit = timed(lambda: [writer.submit(job) for job in jobs])
+    _, t_durable = timed(lambda: [f.result() for f in futures])
+    row("JobWriter submit", args.n, t_submit, t_legacy)
+    row("JobWriter durable", args.n, t_submit + t_durable, t_legacy)
+    writer.close()
+    queued.close()
+    
+    pages = 200
+    _, t_glob = timed(lambda: [sorted((root / "legacy").glob("*.json"))[-20:] for _ in range(pages)])
+    _, t_page = timed(lambda: [journal.page(len(journal) - 20, 20) for _ in range(pages)])
+    row("glob + sort, last 20", pages, t_glob)
+    row("journal.page, last 20", pages, t_page, t_glob)
+    
+    ok = len(journal) == args.n and sorted(j["timestamp"] for j in journal.scan()) == sorted(
+        j["timestamp"] for j in jobs)
+    journal.close()
+    shutil.rmtree(root)
+    print(f"  journal intact: {ok}")
+    return ok
+
+
+def bench_query(args):
+    from datetime import datetime
+    
+    rng = random.Random(args.seed)
+    root = Path(tempfile.mkdtemp())
+    journal = main.JobJournal(str(root))
+    for i in range(0, args.n, 5000):
+        journal.append_many([random_job(rng, k) for k in range(i, min(i + 5000, args.n))])
+    print(f"query: {args.n} jobs")
+    
+    index, t_build = timed(lambda: main.JobIndex(journal))
+    _, t_refresh = timed(index.refresh)
+    row("index build", args.n, t_build + t_refresh)
+    
+    since = datetime.fromisoformat("2026-05-01").timestamp()
+    queries = (
+        ("beam_length > 100", {"beam_length": (math.nextafter(100, math.inf), math.inf)}, None,
+         lambda j: j["outputs"]["beam_length"] > 100),
+        ("circ 40..42, sulphur", {"circumference": (40, 42)}, "sulphur",
+         lambda j: 40 <= j["inputs"]["circumference"] <= 42 and "sulphur" in j["location"].lower()),
+        ("since May, beam > 60", {"timestamp": (since, math.inf), "beam_length": (60.5, math.inf)}, None,
+         lambda j: datetime.fromisoformat(j["timestamp"]).timestamp() >= since
+         and j["outputs"]["beam_length"] >= 60.5),
+    )
+    jobs, t_load = timed(lambda: list(journal.scan()))
+    row("full scan (load)", args.n, t_load)
+    ok = True
+    for label, ranges, location, keep in queries:
+        expected, t_scan = timed(lambda: [j["id"] for j in jobs if keep(j)])
+        found, t_query = timed(index.query, ranges, location)
+        print(f"  {label:<22} {len(found):>7} hits  scan {t_scan * 1000:8.2f} ms  "
+              f"index {t_query * 1000:8.2f} ms  x{t_scan / t_query:.0f}")
+        ok &= found == expected
+    
+    from array import array
+    points = main.PointSet(array("d", (j["lat"] for j in jobs)), array("d", (j["lon"] for j in jobs)))
+    for radius in (300, 3000):
+        origin = (30.2 + rng.uniform(-0.05, 0.05), -93.3 + rng.uniform(-0.05, 0.05))
+        dists, t_scan = timed(main.haversine_many, *origin, points)
+        hits, t_near = timed(index.near, *origin, radius)
+        print(f"  {f'near {radius} ft':<22} {len(hits):>7} hits  scan {t_scan * 1000:8.2f} ms  "
+              f"index {t_near * 1000:8.2f} ms  x{t_scan / t_near:.0f}")
+        ok &= sorted(i for i, _ in hits) == [i for i, d in enumerate(dists) if d <= radius]
+    journal.close()
+    shutil.rmtree(root)
+    print(f"  results match: {ok}")
+    return ok
+
+
+def bench_sync(args):
+    import gzip
+    import threading
+    from http.server import ThreadingHTTPServer
+    
+    rng = random.Random(args.seed)
+    root = Path(tempfile.mkdtemp())
+    device = main.JobJournal(str(root / "device"))
+    device.append_many([random_job(rng, i) for i in range(args.n)])
+    jobs = list(device.scan())
+    raw, packed = b"".join(json.dumps(job).encode() + b"\n" for job in jobs), main.pack_jobs(jobs)
+    print(f"sync: {args.n} jobs, {len(raw) / 1024:.0f} KiB as JSON lines ({len(gzip.compress(raw)) / 1024:.0f} "
+          f"gzipped), {len(packed) / 1024:.0f} KiB packed ({len(gzip.compress(packed)) / 1024:.0f} gzipped)")
+    
+    central = main.JobJournal(str(root / "central"))
+    handler = type("Handler", (main._CollectorHandler,), {"collector": main.JobCollector(central)})
+    
+    def start(port=0):
+        server = ThreadingHTTPServer(("127.0.0.1", port), handler)
+        threading.Thread(target=server.serve_forever, daemon=True).start()
+        return server, f"http://127.0.0.1:{server.server_port}"
+    
+    def sync(url):
+        return list(main.sync_jobs(device, url, args.batch, retries=0))[-1]
+    
+    server, url = start()
+    syncing = main.sync_jobs(device, url, args.batch, retries=0)
+    for _, report in zip(range(4), syncing):
+        pass
+    server.shutdown()
+    server.server_close()
+    try:
+        next(syncing)
+        interrupted = False
+    except OSError:
+        interrupted = True
+    print(f"  link dropped at job {report['cursor']}: sync raised {interrupted}")
+    
+    server, url = start(server.server_port)
+    report, t_resume = timed(sync, url)
+    row("resume after drop", report["sent"], t_resume)
+    report, t_noop = timed(sync, url)
+    print(f"  re-sync from cursor       {t_noop * 1000:.2f} ms, {report['batches']} batches")
+    os.remove(root / "device" / "sync_cursor.json")
+    report, t_dedup = timed(sync, url)
+    row("cursor lost, dedup", args.n, t_dedup, t_resume)
+    print(f"    {report['bytes'] / 1024:.0f} KiB of digests, {report['sent']} jobs re-sent")
+    delta = args.n // 100
+    device.append_many([random_job(rng, args.n + i) for i in range(delta)])
+    report, t_delta = timed(sync, url)
+    row(f"delta of {delta}", report["sent"], t_delta)
+    
+    ok = interrupted and {main.job_digest(job) for job in central.scan()} == {
+        main.job_digest(job) for job in device.scan()}
+    server.shutdown()
+    server.server_close()
+    device.close()
+    central.close()
+    shutil.rmtree(root)
+    print(f"  collector matches device: {ok}")
+    return ok
+
+
+def bench_reconcile(args):
+    import threading
+    from datetime import datetime, timedelta
+    from http.server import ThreadingHTTPServer
+    
+    rng = random.Random(args.seed)
+    start = datetime(2025, 1, 1)
+    
+    def job(i):
+        j = random_job(rng, i)
+        j["timestamp"] = (start + timedelta(minutes=10 * i + rng.random())).isoformat()
+        return j
+    
+    jobs = [job(i) for i in range(args.n + 2 * args.diff)]
+    rng.shuffle(jobs)  # the differences land anywhere in the time range
+    only_a, only_b, shared = jobs[:args.diff], jobs[args.diff:2 * args.diff], jobs[2 * args.diff:]
+    root = Path(tempfile.mkdtemp())
+    a, b = main.JobJournal(str(root / "a")), main.JobJournal(str(root / "b"))
+    a.append_many(shared + only_a)
+    b.append_many(rng.sample(shared, len(shared)) + only_b)  # same jobs, other save order and ids
+    print(f"reconcile: {args.n} shared jobs, {args.diff} only on each side")
+    
+    ours, t_tree = timed(main.JobCollector, a)
+    theirs = main.JobCollector(b)
+    row("digest + tree build", len(a), t_tree)
+    
+    handler = type("Handler", (main._CollectorHandler,), {"collector": theirs})
+    server = ThreadingHTTPServer(("127.0.0.1", 0), handler)
+    threading.Thread(target=server.serve_forever, daemon=True).start()
+    remote = main.RemoteCollector(f"http://127.0.0.1:{server.server_port}", retries=0)
+    report, t_sync = timed(main.reconcile, ours, remote)
+    naive = 64 * (len(a) + len(b))
+    print(f"  merkle over HTTP        {t_sync * 1000:8.1f} ms  {remote.requests} requests, "
+          f"{report['rounds']} rounds, {report['differing_buckets']} buckets, {remote.bytes / 1024:.0f} KiB")
+    print(f"  full digest exchange              {naive / 1024:.0f} KiB  x{naive / remote.bytes:.0f}")
+    again, t_again = timed(main.reconcile, ours, remote)
+    print(f"  re-run when in sync     {t_again * 1000:8.2f} ms  {again['rounds']} round")
+    
+    ok = (report["pulled"], report["pushed"]) == (args.diff, args.diff) and again["pulled"] == again["pushed"] == 0
+    ok &= ours.tree.hash() == theirs.tree.hash() and set(ours.digests) == set(theirs.digests)
+    server.shutdown()
+    server.server_close()
+    a.close()
+    b.close()
+    shutil.rmtree(root)
+    print(f"  stores identical: {ok}")
+    return ok
+
+
+def bench_codec(args):
+    import gzip
+    from datetime import datetime, timedelta
+    
+    rng = random.Random(args.seed)
+    start = datetime(2025, 1, 1)
+    jobs = []
+    for i in range(args.n):
+        job = random_job(rng, i)
+        job["timestamp"] = (start + timedelta(seconds=rng.uniform(0, 3e7))).isoformat()
+        jobs.append(job)
+    indented = [json.dumps(job, indent=2).encode() for job in jobs]
+    compact = [main.encode_job(job, "json") for job in jobs]
+    binary = [main.encode_job(job, "binary") for job in jobs]
+    print(f"codec: {args.n} beam_wizard jobs, {sum(p[:1] == b'{' for p in binary)} stored as JSON")
+    for label, payloads in (("indented JSON file", indented), ("compact JSON", compact), ("binary v1", binary)):
+        size = sum(map(len, payloads))
+        print(f"  {label:<22} {size / args.n:7.1f} B/job  {len(gzip.compress(b''.join(payloads))) / args.n:6.1f} "
+              f"B/job gzipped")
+    
+    root = Path(tempfile.mkdtemp())
+    for i, data in enumerate(indented):
+        (root / f"job_{i:08d}.json").write_bytes(data)
+    paths = sorted(root.glob("job_*.json"))
+    
+    def load_files():
+        for path in paths:
+            with open(path) as f:
+                json.load(f)
+    
+    _, t_files = timed(load_files)
+    _, t_json = timed(lambda: [main.decode_job(p) for p in compact])
+    _, t_binary = timed(lambda: [main.decode_job(p) for p in binary])
+    row("json.load per file", args.n, t_files)
+    row("json.loads compact", args.n, t_json, t_files)
+    row("decode_job binary", args.n, t_binary, t_json)
+    
+    scans, t_scans = {}, {}
+    for codec in ("json", "binary"):
+        with main.JobJournal(str(root / codec), codec) as journal:
+            journal.append_many(jobs)
+            base = t_scans.get("json")
+            scans[codec], t_scans[codec] = timed(lambda: list(journal.scan()))
+            row(f"journal scan, {codec}", args.n, t_scans[codec], base)
+            print(f"    journal.bin {os.path.getsize(journal.path) / 1024:.0f} KiB")
+    shutil.rmtree(root)
+    
+    ok = all(main._compact_json(main.decode_job(b)) == c for b, c in zip(binary, compact))
+    ok &= scans["binary"] == scans["json"]
+    print(f"  lossless round trip: {ok}")
+    return ok
+
+
+def bench_columnar(args):
+    rng = random.Random(args.seed)
+    jobs = [random_job(rng, i) for i in range(args.n)]
+    root = Path(tempfile.mkdtemp())
+    for i, job in enumerate(jobs):
+        (root / f"job_{i:08d}.json").write_text(json.dumps(job, indent=2))
+    journal = main.JobJournal(str(root / "store"))
+    journal.append_many(jobs)
+    print(f"columnar: {args.n} jobs")
+    
+    def load_files():
+        total = 0.0
+        for path in sorted(root.glob("job_*.json")):
+            with open(path) as f:
+                total += json.load(f)["outputs"]["beam_length"]
+        return total
+    
+    expected = math.fsum(job["outputs"]["beam_length"] for job in jobs)
+    path = str(root / "jobs.ptcc")
+    _, t_export = timed(main.write_columns, path, journal.scan())
+    files, t_files = timed(load_files)
+    scanned, t_scan = timed(lambda: math.fsum(j["outputs"]["beam_length"] for j in journal.scan()))
+    
+    def mapped():
+        with main.ColumnFile(path) as columns:
+            view = columns.values("outputs.beam_length")
+            total = math.fsum(view)
+            view.release()
+            return total, columns.stats("outputs.total_mesh_sqft")["sum"]
+    
+    (total, mesh), t_mapped = timed(mapped)
+    row("export --columnar", args.n, t_export)
+    row("sum beam: json files", args.n, t_files)
+    row("sum beam: journal scan", args.n, t_scan, t_files)
+    row("sum beam: mmap column", args.n, t_mapped, t_files)
+    size = os.path.getsize(path)
+    print(f"  column file {size / 1024:.0f} KiB, beam_length column {args.n * 8 / 1024:.0f} KiB of it")
+    
+    ok = all(math.isclose(v, expected) for v in (files, scanned, total))
+    ok &= math.isclose(mesh, math.fsum(job["outputs"]["total_mesh_sqft"] for job in jobs))
+    journal.close()
+    shutil.rmtree(root)
+    print(f"  sums match: {ok}")
+    return ok
+
+
+def bench_totals(args):
+    import threading
+    
+    rng = random.Random(args.seed)
+    
+    def jobs(start, count):
+        return [{**random_job(rng, i), "crew": rng.choice("ABCD")} for i in range(start, start + count)]
+    
+    root = Path(tempfile.mkdtemp())
+    journal = main.JobJournal(str(root))
+    journal.append_many(jobs(0, args.n))
+    print(f"totals: {args.n} jobs, then {args.new} more")
+    
+    totals, t_full = timed(lambda: main.JobTotals(journal))
+    _, t_scan = timed(totals.update)
+    row("first run (full scan)", args.n, t_full + t_scan)
+    journal.append_many(jobs(args.n, args.new))
+    restarted, t_load = timed(main.JobTotals, journal)
+    _, t_new = timed(restarted.update)
+    row(f"restart + {args.new} new", args.new, t_load + t_new, t_full + t_scan)
+    
+    ok = True
+    for mode in ("inotify", "polling"):
+        watcher = main.StoreWatcher(journal.index_path, interval=0.05)
+        if watcher.mode != mode:
+            watcher.close()
+            if mode == "inotify":
+                print("  inotify unavailable")
+                continue
+            watcher.mode, watcher._stamp = "polling", watcher._stat()
+        lags = []
+        for _ in range(args.rounds):
+            extra = jobs(0, 1)
+            timer = threading.Timer(0.01, journal.append, (extra[0],))
+            timer.start()
+            started = time.perf_counter()
+            watcher.wait(5)
+            restarted.update()
+            lags.append(time.perf_counter() - started - 0.01)
+            timer.join()
+        watcher.close()
+        lags.sort()
+        print(f"  watch ({mode:<7}) append -> totals: p50 {lags[len(lags) // 2] * 1000:6.2f} ms  "
+              f"max {lags[-1] * 1000:6.2f} ms")
+    
+    os.remove(restarted.path)
+    fresh = main.JobTotals(journal)
+    fresh.update()
+    for group in main.TOTALS_GROUPS:
+        for a, b in zip(fresh.rows(group), restarted.rows(group)):
+            ok &= a.keys() == b.keys() and all(math.isclose(a[k], b[k]) if isinstance(a[k], float) else a[k] == b[k]
+                                               for k in a)
+    journal.close()
+    shutil.rmtree(root)
+    print(f"  incremental totals match a full recount: {ok}")
+    return ok
+
+
+def main_():
+    parser = argparse.ArgumentParser(description="Pipe Trades CLI benchmarks")
+    parser.add_argument("--seed", type=int, default=42)
+    sub = parser.add_subparsers(dest="suite", required=True)
+
+    p = sub.add_parser("decode")
+    p.add_argument("--n", type=int, default=200_000)
+    p.set_defaults(fn=bench_decode)
+
+    p = sub.add_parser("encode")
+    p.add_argument("--n", type=int, default=200_000)
+    p.add_argument("--length", type=int, default=main.PAIR_CODE_LENGTH)
+    p.set_defaults(fn=bench_encode)
+
+    p = sub.add_parser("gazetteer")
+    p.add_argument("--localities", type=int, default=5000)
+    p.add_argument("--n", type=int, default=20_000)
+    p.set_defaults(fn=bench_gazetteer)
+
+    p = sub.add_parser("distance")
+    p.add_argument("--n", type=int, default=1000)
+    p.add_argument("--jobs", type=int, default=0)
+    p.set_defaults(fn=bench_distance)
+
+    p = sub.add_parser("geodesic")
+    p.add_argument("--n", type=int, default=100_000)
+    p.set_defaults(fn=bench_geodesic)
+
+    p = sub.add_parser("beam")
+    p.add_argument("--n", type=int, default=200_000)
+    p.set_defaults(fn=bench_beam)
+
+    p = sub.add_parser("daemon")
+    p.add_argument("--n", type=int, default=2000, help="calls over one daemon connection")
+    p.add_argument("--cold", type=int, default=20, help="process-per-call invocations")
+    p.set_defaults(fn=bench_daemon)
+    
+    p = sub.add_parser("cache")
+    p.add_argument("--n", type=int, default=200_000)
+    p.add_argument("--distinct", type=int, default=500)
+    p.set_defaults(fn=bench_cache)
+    
+    p = sub.add_parser("journal")
+    p.add_argument("--n", type=int, default=20_000)
+    p.add_argument("--threads", type=int, default=8)
+    p.set_defaults(fn=bench_journal)
+    
+    p = sub.add_parser("query")
+    p.add_argument("--n", type=int, default=100_000)
+    p.set_defaults(fn=bench_query)
+    
+    p = sub.add_parser("sync")
+    p.add_argument("--n", type=int, default=20_000)
+    p.add_argument("--batch", type=int, default=main.SYNC_BATCH)
+    p.set_defaults(fn=bench_sync)
+    
+    p = sub.add_parser("reconcile")
+    p.add_argument("--n", type=int, default=100_000)
+    p.add_argument("--diff", type=int, default=50, help="jobs only on each side")
+    p.set_defaults(fn=bench_reconcile)
+    
+    p = sub.add_parser("codec")
+    p.add_argument("--n", type=int, default=50_000)
+    p.set_defaults(fn=bench_codec)
+    
+    p = sub.add_parser("columnar")
+    p.add_argument("--n", type=int, default=50_000)
+    p.set_defaults(fn=bench_columnar)
+    
+    p = sub.add_parser("totals")
+    p.add_argument("--n", type=int, default=100_000)
+    p.add_argument("--new", type=int, default=50)
+    p.add_argument("--rounds", type=int, default=20, help="appends timed per watch mode")
+    p.set_defaults(fn=bench_totals)
+    
+    args = parser.parse_args()
+    sys.exit(0 if args.fn(args) else 1)
+
+
+if __name__ == "__main__":
+    main_()
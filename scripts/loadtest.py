@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""
+PIPE TRADES CLI - HTTP Load Test
+================================
+Mixed beam/offset/cutback/calibrate/decode/distance traffic against
+`main.py http` over keep-alive connections, one client process each.
+
+Latency target (local instance, one keep-alive connection per client,
+clients <= cores): p50 <= 2 ms, p99 <= 10 ms. The run fails when the
+measured percentiles exceed --p50-ms / --p99-ms.
+
+Usage:
+    python scripts/loadtest.py                       # starts a local instance
+    python scripts/loadtest.py --clients 8 --duration 30 --workers 4
+    python scripts/loadtest.py --url http://ptc.plant.local:8080 --p99-ms 25
+"""
+
+import argparse
+import http.client
+import json
+import multiprocessing
+import os
+import random
+import subprocess
+import sys
+import time
+import urllib.parse
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+
+REQUESTS = (
+    ("GET", "/offset?angle=45&offset=5", None),
+    ("GET", "/cutback?angle=22.5&offset=8", None),
+    ("POST", "/beam", {"circ": 44, "shoes": 4, "boot": 6, "rise": 30}),
+    ("POST", "/beam", {"circ": 62, "shoes": 6, "boot": 3, "rise": 12}),
+    ("GET", "/calibrate?satellite=305&field=301", None),
+    ("POST", "/decode", {"code": "5MHH+P8G Lake Charles"}),
+    ("GET", "/distance?from=30.2266,-93.2174&to=30.2301,-93.2102&engine=vincenty", None),
+)
+
+
+def client(url: str, deadline: float, seed: int, results):
+    parts = urllib.parse.urlsplit(url)
+    conn = http.client.HTTPConnection(parts.hostname, parts.port or 80)
+    rng = random.Random(seed)
+    latencies, errors = [], 0
+    while time.time() < deadline:
+        method, path, body = rng.choice(REQUESTS)
+        data = json.dumps(body).encode() if body else None
+        started = time.perf_counter()
+        conn.request(method, path, data, {"Content-Type": "application/json"} if data else {})
+        resp = conn.getresponse()
+        resp.read()
+        latencies.append(time.perf_counter() - started)
+        errors += resp.status != 200
+    conn.close()
+    results.put((latencies, errors))
+
+
+def wait_ready(url: str, timeout: float = 10):
+    parts = urllib.parse.urlsplit(url)
+    until = time.time() + timeout
+    while time.time() < until:
+        try:
+            conn = http.client.HTTPConnection(parts.hostname, parts.port, timeout=1)
+            conn.request("GET", "/readyz")
+            if conn.getresponse().status == 200:
+                return
+            conn.close()  # 503 while the worker warms up
+        except OSError:
+            pass
+        time.sleep(0.05)
+    sys.exit(f"{url} not ready after {timeout:.0f}s")
+
+
+def percentile(ranked, p: float) -> float:
+    return ranked[min(len(ranked) - 1, int(p / 100 * len(ranked)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pipe Trades CLI HTTP load test")
+    parser.add_argument("--url", help="existing service (default: start main.py http locally)")
+    parser.add_argument("--port", type=int, default=18080, help="port for the local instance")
+    parser.add_argument("--workers", type=int, default=0, help="local instance workers (default: all cores)")
+    parser.add_argument("--clients", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--duration", type=float, default=10, help="seconds")
+    parser.add_argument("--p50-ms", type=float, default=2.0)
+    parser.add_argument("--p99-ms", type=float, default=10.0)
+    args = parser.parse_args()
+
+    server = None
+    url = args.url
+    if not url:
+        url = f"http://127.0.0.1:{args.port}"
+        server = subprocess.Popen([sys.executable, str(ROOT / "main.py"), "http", "--host", "127.0.0.1",
+                                   "--port", str(args.port), "--workers", str(args.workers)])
+    try:
+        wait_ready(url)
+        results = multiprocessing.Queue()
+        deadline = time.time() + args.duration
+        procs = [multiprocessing.Process(target=client, args=(url, deadline, i, results))
+                 for i in range(args.clients)]
+        for proc in procs:
+            proc.start()
+        runs = [results.get() for _ in procs]
+        for proc in procs:
+            proc.join()
+    finally:
+        if server:
+            server.terminate()
+            server.wait()
+
+    ranked = sorted(t for latencies, _ in runs for t in latencies)
+    errors = sum(e for _, e in runs)
+    p50, p90, p99 = (percentile(ranked, p) * 1000 for p in (50, 90, 99))
+    print(f"{url}: {len(ranked):,} requests, {args.clients} clients, {args.duration:.0f}s "
+          f"- {len(ranked) / args.duration:,.0f} req/s, {errors} errors")
+    print(f"  p50 {p50:.3f} ms  p90 {p90:.3f} ms  p99 {p99:.3f} ms  max {ranked[-1] * 1000:.3f} ms")
+    ok = errors == 0 and p50 <= args.p50_ms and p99 <= args.p99_ms
+    print(f"  target p50 <= {args.p50_ms} ms, p99 <= {args.p99_ms} ms: {'met' if ok else 'MISSED'}")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()